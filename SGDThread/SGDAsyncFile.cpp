@@ -0,0 +1,191 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDAsyncFile.h"
+#include "SGDTaskScheduler.h"
+using namespace SGD;
+
+H1AsyncFileIO::H1AsyncFileIO()
+{
+
+}
+
+H1AsyncFileIO::~H1AsyncFileIO()
+{
+
+}
+
+void H1AsyncFileIO::Submit(H1FileIORequest* pRequest)
+{
+	assert(pRequest->Latch != nullptr && "[invalid] the request needs the latch to wait for");
+
+	// run it as blocking call in the offload thread (the caller doesn't wait here)
+	pRequest->OffloadRequest.EntryPoint = ExecuteBlocking;
+	pRequest->OffloadRequest.Data = pRequest;
+	pRequest->OffloadRequest.Completion = CompleteOffloadRequest;
+	H1TaskSchedulerLayer::GetTaskScheduler()->GetOffloadPool().Post(&pRequest->OffloadRequest);
+}
+
+int64_t H1AsyncFileIO::SubmitAndWait(H1FileIORequest& request)
+{
+	H1FiberLatch latch(1);
+	request.Latch = &latch;
+	Submit(&request);
+	latch.Wait();
+	return request.Result;
+}
+
+int64_t H1AsyncFileIO::Read(FileHandle handle, void* buffer, size_t size, uint64_t offset)
+{
+	H1FileIORequest request;
+	request.Operation = EFIO_Read;
+	request.Handle = handle;
+	request.Buffer = buffer;
+	request.Size = size;
+	request.Offset = offset;
+	return SubmitAndWait(request);
+}
+
+int64_t H1AsyncFileIO::Write(FileHandle handle, const void* buffer, size_t size, uint64_t offset)
+{
+	H1FileIORequest request;
+	request.Operation = EFIO_Write;
+	request.Handle = handle;
+	request.Buffer = const_cast<void*>(buffer);
+	request.Size = size;
+	request.Offset = offset;
+	return SubmitAndWait(request);
+}
+
+int64_t H1AsyncFileIO::ReadV(FileHandle handle, const H1FileIOVector* vectors, int32_t vectorCounts, uint64_t offset)
+{
+	H1FileIORequest request;
+	request.Operation = EFIO_ReadV;
+	request.Handle = handle;
+	request.Vectors = vectors;
+	request.VectorCounts = vectorCounts;
+	request.Offset = offset;
+	return SubmitAndWait(request);
+}
+
+bool H1AsyncFileIO::Sync(FileHandle handle)
+{
+	H1FileIORequest request;
+	request.Operation = EFIO_Sync;
+	request.Handle = handle;
+	return SubmitAndWait(request) == 0;
+}
+
+void H1AsyncFileIO::ExecuteBlocking(void* pData)
+{
+	H1FileIORequest* pRequest = reinterpret_cast<H1FileIORequest*>(pData);
+	int64_t result = -1;
+
+	// synchronous handle; the offset is given by OVERLAPPED
+	//	- the system serializes the calls on the same handle, so the concurrent requests to one file don't overlap
+	uint64_t offset = pRequest->Offset;
+	auto ReadAt = [pRequest, &offset](void* buffer, size_t size) -> int64_t
+	{
+		OVERLAPPED overlapped;
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		DWORD transferredBytes = 0;
+		if (!ReadFile(pRequest->Handle, buffer, static_cast<DWORD>(size), &transferredBytes, &overlapped))
+			return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+		offset += transferredBytes;
+		return transferredBytes;
+	};
+
+	switch (pRequest->Operation)
+	{
+	case EFIO_Read:
+		result = ReadAt(pRequest->Buffer, pRequest->Size);
+		break;
+	case EFIO_Write:
+		{
+			OVERLAPPED overlapped;
+			memset(&overlapped, 0, sizeof(overlapped));
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD transferredBytes = 0;
+			if (WriteFile(pRequest->Handle, pRequest->Buffer, static_cast<DWORD>(pRequest->Size), &transferredBytes, &overlapped))
+				result = transferredBytes;
+		}
+		break;
+	case EFIO_ReadV:
+		// read the vectors one by one until the short read (same result as preadv)
+		result = 0;
+		for (int32_t index = 0; index < pRequest->VectorCounts; ++index)
+		{
+			const H1FileIOVector& vector = pRequest->Vectors[index];
+			int64_t readBytes = ReadAt(vector.Buffer, vector.Size);
+			if (readBytes < 0)
+			{
+				result = result > 0 ? result : -1;
+				break;
+			}
+			result += readBytes;
+			if (static_cast<size_t>(readBytes) < vector.Size)
+				break;
+		}
+		break;
+	case EFIO_Sync:
+		result = FlushFileBuffers(pRequest->Handle) ? 0 : -1;
+		break;
+	}
+	pRequest->Result = result;
+}
+
+void H1AsyncFileIO::CompleteOffloadRequest(void* pData)
+{
+	// NOTE THAT - don't touch the request after its latch is counted down (the waiter owns it)
+	H1FileIORequest* pRequest = reinterpret_cast<H1FileIORequest*>(pData);
+	pRequest->Latch->CountDown();
+}
+
+FileHandle H1AsyncFileIO::OpenFile(const char* path, EFileOpenMode mode)
+{
+	DWORD access = GENERIC_READ;
+	DWORD disposition = OPEN_EXISTING;
+	if (mode == EFOM_Write)
+	{
+		access = GENERIC_WRITE;
+		disposition = CREATE_ALWAYS;
+	}
+	else if (mode == EFOM_ReadWrite)
+	{
+		access = GENERIC_READ | GENERIC_WRITE;
+		disposition = OPEN_ALWAYS;
+	}
+	// no FILE_FLAG_OVERLAPPED; the blocking fallback has queue depth 1 per handle
+	return CreateFileA(path, access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+}
+
+void H1AsyncFileIO::CloseFile(FileHandle handle)
+{
+	if (handle == InvalidFileHandle)
+		return;
+	CloseHandle(handle);
+}
@@ -0,0 +1,123 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "SGDFiberBarrier.h"
+#include "SGDOffloadPool.h"
+
+namespace SGD
+{
+	// native handle of the file
+	typedef void* FileHandle;
+	const FileHandle InvalidFileHandle = FileHandle(-1);
+
+	enum EFileIOOperation
+	{
+		EFIO_Read,
+		EFIO_Write,
+		EFIO_ReadV,
+		EFIO_Sync,
+	};
+
+	enum EFileOpenMode
+	{
+		EFOM_Read,
+		// create (or truncate) the file
+		EFOM_Write,
+		EFOM_ReadWrite,
+	};
+
+	// scatter buffer of ReadV
+	struct H1FileIOVector
+	{
+		void* Buffer;
+		size_t Size;
+	};
+
+	// positional file I/O submitted by H1AsyncFileIO (it could live on the fiber stack)
+	//	- the caller owns the request and the buffers until the latch is counted down
+	struct H1FileIORequest
+	{
+		H1FileIORequest()
+			: Operation(EFIO_Read)
+			, Handle(InvalidFileHandle)
+			, Buffer(nullptr)
+			, Size(0)
+			, Vectors(nullptr)
+			, VectorCounts(0)
+			, Offset(0)
+			, Result(-1)
+			, Latch(nullptr)
+			, OffloadRequest(nullptr, nullptr)
+		{}
+
+		EFileIOOperation Operation;
+		FileHandle Handle;
+		// EFIO_Read, EFIO_Write
+		void* Buffer;
+		size_t Size;
+		// EFIO_ReadV
+		const H1FileIOVector* Vectors;
+		int32_t VectorCounts;
+		uint64_t Offset;
+		// transferred bytes (0 for EFIO_Sync), -1 on error
+		int64_t Result;
+		// counted down when the request completes (the batch could share one latch)
+		H1FiberLatch* Latch;
+		// fallback to the offload thread pool
+		H1OffloadRequest OffloadRequest;
+	};
+
+	// asynchronous file I/O for the fibers
+	//	- the request runs as blocking call in H1OffloadPool; the fiber waiting for its latch is parked instead of the worker thread
+	//	- the fiber issuing many requests shares one latch to keep them in flight at once (up to the offload threads)
+	//	- NOTE THAT - the queue depth is 1 per handle; OpenFile returns the synchronous handle (no FILE_FLAG_OVERLAPPED),
+	//	  so the requests on the same handle are serialized by the system even across the offload threads
+	class H1AsyncFileIO
+	{
+	public:
+		H1AsyncFileIO();
+		~H1AsyncFileIO();
+
+		// queue the request without waiting; wait for its latch
+		void Submit(H1FileIORequest* pRequest);
+
+		// submit one request and suspend current fiber until it completes; return the transferred bytes (-1 on error)
+		int64_t Read(FileHandle handle, void* buffer, size_t size, uint64_t offset);
+		int64_t Write(FileHandle handle, const void* buffer, size_t size, uint64_t offset);
+		int64_t ReadV(FileHandle handle, const H1FileIOVector* vectors, int32_t vectorCounts, uint64_t offset);
+		bool Sync(FileHandle handle);
+
+		// file utilities
+		//	- the synchronous handle (see the queue depth note above)
+		static FileHandle OpenFile(const char* path, EFileOpenMode mode);
+		static void CloseFile(FileHandle handle);
+
+	private:
+		static void ExecuteBlocking(void* pData);
+		static void CompleteOffloadRequest(void* pData);
+
+		int64_t SubmitAndWait(H1FileIORequest& request);
+	};
+}
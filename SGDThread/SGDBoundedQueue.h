@@ -0,0 +1,168 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+namespace SGD
+{
+	// bounded lock-free MPMC ring queue (Vyukov-style sequence numbers)
+	//	- specialized for small trivially-copyable elements (task pointers, FiberIds); the ring never allocates after Initialize
+	//	- each cell carries the sequence number telling whether it is ready to enqueue or to dequeue at the position
+	//	- enqueue/dequeue positions are on separated cache lines so producers and consumers don't bounce one line
+	//	- each cell is on its own cache line, so the producer and the consumer of the neighbor positions don't share a line
+	//	- TryEnqueue fails when the ring is full, TryDequeue fails when it is empty
+	template <typename ElementType>
+	class H1BoundedQueue
+	{
+	public:
+		H1BoundedQueue()
+			: m_Cells(nullptr)
+			, m_Mask(0)
+			, m_EnqueuePosition(0)
+			, m_DequeuePosition(0)
+		{}
+
+		~H1BoundedQueue()
+		{
+			Destroy();
+		}
+
+		// the capacity is rounded up to the power of two
+		bool Initialize(uint32_t capacity)
+		{
+			size_t roundedCapacity = 2;
+			while (roundedCapacity < capacity)
+				roundedCapacity <<= 1;
+
+			// operator new doesn't over-align before C++17
+			m_Cells = reinterpret_cast<Cell*>(appAllocateAlignedMemory(sizeof(Cell) * roundedCapacity, alignof(Cell)));
+			if (m_Cells == nullptr)
+				return false;
+			for (size_t i = 0; i < roundedCapacity; ++i)
+			{
+				new (&m_Cells[i]) Cell();
+				m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+			m_Mask = roundedCapacity - 1;
+
+			m_EnqueuePosition.store(0, std::memory_order_relaxed);
+			m_DequeuePosition.store(0, std::memory_order_relaxed);
+			return true;
+		}
+
+		void Destroy()
+		{
+			if (m_Cells == nullptr)
+				return;
+
+			for (size_t i = 0; i <= m_Mask; ++i)
+				m_Cells[i].~Cell();
+			appFreeAlignedMemory(m_Cells);
+			m_Cells = nullptr;
+			m_Mask = 0;
+		}
+
+		bool TryEnqueue(const ElementType& element)
+		{
+			Cell* pCell = nullptr;
+			size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+			while (true)
+			{
+				pCell = &m_Cells[position & m_Mask];
+				size_t sequence = pCell->Sequence.load(std::memory_order_acquire);
+				intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+				if (difference == 0)
+				{
+					// the cell is free at this position; claim it
+					if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+					return false; // the cell is not dequeued yet since the previous lap (full)
+				else
+					position = m_EnqueuePosition.load(std::memory_order_relaxed);
+			}
+
+			pCell->Element = element;
+			// publish the element to the consumer of this position
+			pCell->Sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool TryDequeue(ElementType& element)
+		{
+			Cell* pCell = nullptr;
+			size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+			while (true)
+			{
+				pCell = &m_Cells[position & m_Mask];
+				size_t sequence = pCell->Sequence.load(std::memory_order_acquire);
+				intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+				if (difference == 0)
+				{
+					// the element is published at this position; claim it
+					if (m_DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+					return false; // the cell is not enqueued yet (empty)
+				else
+					position = m_DequeuePosition.load(std::memory_order_relaxed);
+			}
+
+			element = pCell->Element;
+			// free the cell for the producer of the next lap
+			pCell->Sequence.store(position + m_Mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		// dequeue elements up to maxElementCounts; return the number of dequeued elements
+		int32_t TryDequeueBulk(ElementType* pElements, int32_t maxElementCounts)
+		{
+			int32_t dequeuedCounts = 0;
+			while (dequeuedCounts < maxElementCounts && TryDequeue(pElements[dequeuedCounts]))
+				++dequeuedCounts;
+			return dequeuedCounts;
+		}
+
+		inline size_t GetCapacity() const { return m_Mask + 1; }
+
+	private:
+		struct alignas(64) Cell
+		{
+			std::atomic<size_t> Sequence;
+			ElementType Element;
+		};
+
+		// ring of cells (read-only after Initialize)
+		Cell* m_Cells;
+		size_t m_Mask;
+		char m_Padding0[64];
+		// producers' position
+		std::atomic<size_t> m_EnqueuePosition;
+		char m_Padding1[64];
+		// consumers' position
+		std::atomic<size_t> m_DequeuePosition;
+		char m_Padding2[64];
+	};
+}
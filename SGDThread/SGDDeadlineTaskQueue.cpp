@@ -0,0 +1,146 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDDeadlineTaskQueue.h"
+#include <algorithm>
+using namespace SGD;
+
+H1DeadlineTaskQueue::H1DeadlineTaskQueue()
+	: m_bLocked(false)
+	, m_HeapCounts(0)
+{
+	// avoid reallocation of the heap for usual frame workload
+	m_DeadlineHeap.reserve(256);
+}
+
+H1DeadlineTaskQueue::~H1DeadlineTaskQueue()
+{
+	// the task left here would never be finished (its waiter never wakes up)
+	assert(IsEmpty() && "[invalid] the deadline tasks are left in the queue");
+}
+
+bool H1DeadlineTaskQueue::CompareDeadline(const H1TaskDeclaration* lhs, const H1TaskDeclaration* rhs)
+{
+	// std heap is max-heap; reverse the order to get the earliest deadline at the front
+	return lhs->GetDeadline() > rhs->GetDeadline();
+}
+
+bool H1DeadlineTaskQueue::EnqueueTask(H1TaskDeclaration* pTask)
+{
+	return m_Inbox.enqueue(pTask);
+}
+
+void H1DeadlineTaskQueue::MoveInboxToHeap()
+{
+	H1TaskDeclaration* pArrivedTask = nullptr;
+	while (m_Inbox.try_dequeue(pArrivedTask))
+	{
+		m_DeadlineHeap.push_back(pArrivedTask);
+		std::push_heap(m_DeadlineHeap.begin(), m_DeadlineHeap.end(), CompareDeadline);
+	}
+}
+
+H1TaskDeclaration* H1DeadlineTaskQueue::PopEarliestTask()
+{
+	MoveInboxToHeap();
+
+	H1TaskDeclaration* pTask = nullptr;
+	if (!m_DeadlineHeap.empty())
+	{
+		std::pop_heap(m_DeadlineHeap.begin(), m_DeadlineHeap.end(), CompareDeadline);
+		pTask = m_DeadlineHeap.back();
+		m_DeadlineHeap.pop_back();
+	}
+	m_HeapCounts.store(static_cast<int32_t>(m_DeadlineHeap.size()), std::memory_order_relaxed);
+	return pTask;
+}
+
+H1TaskDeclaration* H1DeadlineTaskQueue::DequeueTask()
+{
+	if (IsEmpty())
+		return nullptr;
+
+	while (m_bLocked.exchange(true, std::memory_order_acquire))
+	{
+		// spin on the load not to bounce the cache line
+		while (m_bLocked.load(std::memory_order_relaxed))
+			appYieldProcessor();
+	}
+	H1TaskDeclaration* pTask = PopEarliestTask();
+	m_bLocked.store(false, std::memory_order_release);
+	return pTask;
+}
+
+H1TaskDeclaration* H1DeadlineTaskQueue::StealTask()
+{
+	if (IsEmpty() || m_bLocked.exchange(true, std::memory_order_acquire))
+		return nullptr;
+
+	H1TaskDeclaration* pTask = PopEarliestTask();
+	m_bLocked.store(false, std::memory_order_release);
+	return pTask;
+}
+
+H1DeadlineMetrics::H1DeadlineMetrics()
+	: m_FrameIndex(0)
+	, m_DeadlineTaskCounts(0)
+	, m_DeadlineMissCounts(0)
+	, m_MaxLateness(0)
+{
+	m_LastFrameMetrics = { 0, 0, 0, 0 };
+}
+
+void H1DeadlineMetrics::RecordCompletion(uint64_t deadline, uint64_t completedTimestamp)
+{
+	m_DeadlineTaskCounts.fetch_add(1, std::memory_order_relaxed);
+	if (completedTimestamp <= deadline)
+		return;
+
+	m_DeadlineMissCounts.fetch_add(1, std::memory_order_relaxed);
+
+	// update the worst lateness
+	uint64_t lateness = completedTimestamp - deadline;
+	uint64_t maxLateness = m_MaxLateness.load(std::memory_order_relaxed);
+	while (lateness > maxLateness && !m_MaxLateness.compare_exchange_weak(maxLateness, lateness, std::memory_order_relaxed)) {}
+}
+
+H1DeadlineFrameMetrics H1DeadlineMetrics::AdvanceFrame()
+{
+	// completion racing with AdvanceFrame could be counted in the next frame
+	m_LastFrameMetrics.FrameIndex = m_FrameIndex.fetch_add(1, std::memory_order_relaxed);
+	m_LastFrameMetrics.DeadlineTaskCounts = m_DeadlineTaskCounts.exchange(0, std::memory_order_relaxed);
+	m_LastFrameMetrics.DeadlineMissCounts = m_DeadlineMissCounts.exchange(0, std::memory_order_relaxed);
+	m_LastFrameMetrics.MaxLateness = m_MaxLateness.exchange(0, std::memory_order_relaxed);
+	return m_LastFrameMetrics;
+}
+
+H1DeadlineFrameMetrics H1DeadlineMetrics::GetCurrentFrameMetrics() const
+{
+	H1DeadlineFrameMetrics metrics;
+	metrics.FrameIndex = m_FrameIndex.load(std::memory_order_relaxed);
+	metrics.DeadlineTaskCounts = m_DeadlineTaskCounts.load(std::memory_order_relaxed);
+	metrics.DeadlineMissCounts = m_DeadlineMissCounts.load(std::memory_order_relaxed);
+	metrics.MaxLateness = m_MaxLateness.load(std::memory_order_relaxed);
+	return metrics;
+}
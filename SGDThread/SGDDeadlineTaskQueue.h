@@ -0,0 +1,98 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDTask.h"
+
+namespace SGD
+{
+	// per-worker earliest-deadline-first task queue
+	//	- producers push deadline tasks into the lock-free inbox (any thread)
+	//	- the inbox is moved into the binary heap protected by the spin-lock, and the earliest deadline is popped from it
+	//	- other workers steal the earliest deadline from the heap while the owner is busy running long task
+	//	  (the thief only tries the lock; it never waits for the owner)
+	class H1DeadlineTaskQueue
+	{
+	public:
+		H1DeadlineTaskQueue();
+		// all tasks should be dequeued before destruction
+		~H1DeadlineTaskQueue();
+
+		// thread-safe
+		bool EnqueueTask(H1TaskDeclaration* pTask);
+		// called by the owner worker thread
+		H1TaskDeclaration* DequeueTask();
+		// called by other worker threads; null when the heap is locked by others
+		H1TaskDeclaration* StealTask();
+
+		// hint; it could be stale
+		inline bool IsEmpty() const { return m_HeapCounts.load(std::memory_order_relaxed) == 0 && m_Inbox.size_approx() == 0; }
+
+	private:
+		static bool CompareDeadline(const H1TaskDeclaration* lhs, const H1TaskDeclaration* rhs);
+
+		// below methods require the lock
+		void MoveInboxToHeap();
+		H1TaskDeclaration* PopEarliestTask();
+
+		// inbox shared with producers
+		moodycamel::ConcurrentQueue<H1TaskDeclaration*> m_Inbox;
+		// min-heap by deadline protected by the spin-lock
+		std::atomic<bool> m_bLocked;
+		std::vector<H1TaskDeclaration*> m_DeadlineHeap;
+		// size of the heap readable without the lock
+		std::atomic<int32_t> m_HeapCounts;
+	};
+
+	struct H1DeadlineFrameMetrics
+	{
+		uint64_t FrameIndex;
+		// tasks with the deadline finished in the frame
+		int32_t DeadlineTaskCounts;
+		int32_t DeadlineMissCounts;
+		// the worst lateness in timestamp ticks (see appGetTimestampFrequency)
+		uint64_t MaxLateness;
+	};
+
+	// deadline misses accumulated per frame
+	//	- RecordCompletion is thread-safe; AdvanceFrame is called by the thread owning the frame loop
+	class H1DeadlineMetrics
+	{
+	public:
+		H1DeadlineMetrics();
+
+		void RecordCompletion(uint64_t deadline, uint64_t completedTimestamp);
+		// close current frame and start next one; return the metrics of the closed frame
+		H1DeadlineFrameMetrics AdvanceFrame();
+
+		H1DeadlineFrameMetrics GetCurrentFrameMetrics() const;
+		inline const H1DeadlineFrameMetrics& GetLastFrameMetrics() const { return m_LastFrameMetrics; }
+
+	private:
+		std::atomic<uint64_t> m_FrameIndex;
+		std::atomic<int32_t> m_DeadlineTaskCounts;
+		std::atomic<int32_t> m_DeadlineMissCounts;
+		std::atomic<uint64_t> m_MaxLateness;
+		H1DeadlineFrameMetrics m_LastFrameMetrics;
+	};
+}
@@ -0,0 +1,150 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDFiberBarrier.h"
+using namespace SGD;
+
+namespace
+{
+	struct H1FiberBarrierParkData
+	{
+		H1FiberBarrier* Barrier;
+		H1FiberWaiter* Waiter;
+	};
+
+	struct H1FiberLatchParkData
+	{
+		H1FiberLatch* Latch;
+		H1FiberWaiter* Waiter;
+	};
+}
+
+H1FiberBarrier::H1FiberBarrier(int32_t participantCounts)
+	: m_ParticipantCounts(participantCounts)
+	, m_ArrivedCounts(0)
+	, m_Phase(0)
+{
+
+}
+
+bool H1FiberBarrier::ArriveAndWait()
+{
+	H1FiberWaiter waiter;
+	H1FiberBarrierParkData parkData = { this, &waiter };
+	H1FiberWaitQueue::Suspend(&waiter, ParkOnBarrier, &parkData);
+
+	// the last arriver marks own waiter
+	return waiter.Value != 0;
+}
+
+bool H1FiberBarrier::ParkOnBarrier(H1FiberContext* pFiberContext, void* pData)
+{
+	H1FiberBarrierParkData* pParkData = reinterpret_cast<H1FiberBarrierParkData*>(pData);
+	H1FiberBarrier* pBarrier = pParkData->Barrier;
+	H1FiberWaiter* pWaiter = pParkData->Waiter;
+
+	pBarrier->m_Waiters.Lock();
+	if (++pBarrier->m_ArrivedCounts < pBarrier->m_ParticipantCounts)
+	{
+		pBarrier->m_Waiters.PushBack(pWaiter);
+		pBarrier->m_Waiters.Unlock();
+		return true;
+	}
+
+	// the last arriver; start the next phase and release the waiters at once
+	pBarrier->m_ArrivedCounts = 0;
+	pBarrier->m_Phase.fetch_add(1, std::memory_order_release);
+	H1FiberWaiter* pWaiters = pBarrier->m_Waiters.PopAll();
+	pBarrier->m_Waiters.Unlock();
+
+	H1FiberWaitQueue::WakeAll(pWaiters);
+	pWaiter->Value = 1;
+	return false;
+}
+
+H1FiberLatch::H1FiberLatch(int32_t counts)
+	: m_Counts(counts)
+	, m_bReleased(counts == 0)
+{
+
+}
+
+void H1FiberLatch::CountDown(int32_t counts)
+{
+	int32_t prevCounts = m_Counts.fetch_sub(counts, std::memory_order_acq_rel);
+	assert(prevCounts >= counts && "[invalid] the latch is counted down below zero");
+	if (prevCounts != counts)
+		return;
+
+	// the waiters registering after here see the counter zero and don't suspend
+	m_Waiters.Lock();
+	H1FiberWaiter* pWaiters = m_Waiters.PopAll();
+	m_Waiters.Unlock();
+
+	// after here, don't touch the latch (the waiter could destroy it)
+	m_bReleased.store(true, std::memory_order_release);
+	H1FiberWaitQueue::WakeAll(pWaiters);
+}
+
+bool H1FiberLatch::TryWait() const
+{
+	return m_bReleased.load(std::memory_order_acquire);
+}
+
+void H1FiberLatch::Wait()
+{
+	if (TryWait())
+		return;
+
+	H1FiberWaiter waiter;
+	H1FiberLatchParkData parkData = { this, &waiter };
+	H1FiberWaitQueue::Suspend(&waiter, ParkOnLatch, &parkData);
+
+	// the counter reached zero; the last CountDown could be still releasing the waiters, it finishes in a moment
+	while (!TryWait())
+		appYieldProcessor();
+}
+
+void H1FiberLatch::ArriveAndWait(int32_t counts)
+{
+	CountDown(counts);
+	Wait();
+}
+
+bool H1FiberLatch::ParkOnLatch(H1FiberContext* pFiberContext, void* pData)
+{
+	H1FiberLatchParkData* pParkData = reinterpret_cast<H1FiberLatchParkData*>(pData);
+	H1FiberLatch* pLatch = pParkData->Latch;
+
+	pLatch->m_Waiters.Lock();
+	if (pLatch->m_Counts.load(std::memory_order_acquire) == 0)
+	{
+		// already reached zero; resume immediately
+		pLatch->m_Waiters.Unlock();
+		return false;
+	}
+	pLatch->m_Waiters.PushBack(pParkData->Waiter);
+	pLatch->m_Waiters.Unlock();
+	return true;
+}
@@ -0,0 +1,74 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDFiberWaitQueue.h"
+
+namespace SGD
+{
+	// reusable barrier suspending the fibers until all participants arrive
+	//	- the arrival is counted in the park callback (after the fiber left its stack), so the last arriver never wakes the running fiber
+	//	- the last arriver releases the waiters of the phase in one batch and starts the next phase
+	class H1FiberBarrier
+	{
+	public:
+		explicit H1FiberBarrier(int32_t participantCounts);
+
+		// return true for exactly one participant per phase (the last arriver)
+		bool ArriveAndWait();
+
+		inline int32_t GetParticipantCounts() const { return m_ParticipantCounts; }
+		inline uint32_t GetPhase() const { return m_Phase.load(std::memory_order_acquire); }
+
+	private:
+		static bool ParkOnBarrier(H1FiberContext* pFiberContext, void* pData);
+
+		const int32_t m_ParticipantCounts;
+		// protected by the lock of m_Waiters
+		int32_t m_ArrivedCounts;
+		std::atomic<uint32_t> m_Phase;
+		H1FiberWaitQueue m_Waiters;
+	};
+
+	// single-use countdown latch suspending the fibers until the counter reaches zero
+	//	- allocation-free; it could live on the fiber stack
+	//	- the waiter returns only after the last CountDown stopped touching the latch, so the waiter could destroy it right after Wait
+	class H1FiberLatch
+	{
+	public:
+		explicit H1FiberLatch(int32_t counts);
+
+		void CountDown(int32_t counts = 1);
+		void Wait();
+		bool TryWait() const;
+		void ArriveAndWait(int32_t counts = 1);
+
+	private:
+		static bool ParkOnLatch(H1FiberContext* pFiberContext, void* pData);
+
+		std::atomic<int32_t> m_Counts;
+		// set by the last CountDown after it releases the waiters (the last access to the latch by the releaser)
+		std::atomic<bool> m_bReleased;
+		H1FiberWaitQueue m_Waiters;
+	};
+}
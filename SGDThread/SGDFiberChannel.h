@@ -0,0 +1,309 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+#include "SGDFiberWaitQueue.h"
+
+namespace SGD
+{
+	// typed bounded MPMC channel suspending the fibers for back-pressure
+	//	- Send suspends the sender while the channel is full, Recv suspends the receiver while it is empty
+	//	- with the capacity >= 1, the waiters are either all senders (the buffer is full) or all receivers (the buffer is empty),
+	//	  so one waiter queue is enough; the waiter carries the pointer to its element for the direct handoff
+	//	- Close fails the waiting/following senders; the receivers drain the remaining elements and fail after that
+	//	- NOTE THAT - the element type should be default-constructible and movable (the ring is allocated once at construction)
+	template <typename ElementType>
+	class H1FiberChannel
+	{
+	public:
+		explicit H1FiberChannel(uint32_t capacity)
+			: m_Elements(nullptr)
+			, m_Capacity(capacity)
+			, m_Head(0)
+			, m_Counts(0)
+			, m_bClosed(false)
+		{
+			if (m_Capacity == 0)
+			{
+				assert(false && "[invalid] the channel needs the capacity at least one");
+				m_Capacity = 1;
+			}
+			m_Elements = new ElementType[m_Capacity];
+		}
+
+		~H1FiberChannel()
+		{
+			assert(m_Waiters.IsEmpty() && "[invalid] the channel is destroyed while the fibers wait for it");
+			delete[] m_Elements;
+		}
+
+		// return false when the channel is closed (the element is not sent)
+		bool Send(const ElementType& element)
+		{
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			m_Waiters.Lock();
+			ETransferResult result = SendLocked(element, pWakeWaiters);
+			m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+
+			if (result != ETR_WouldBlock)
+				return result == ETR_Done;
+
+			// the channel is full; suspend until the receiver takes the element
+			TransferData transfer = { const_cast<ElementType*>(&element), false };
+			H1FiberWaiter waiter;
+			waiter.Value = reinterpret_cast<intptr_t>(&transfer);
+			ParkData parkData = { this, &waiter };
+			H1FiberWaitQueue::Suspend(&waiter, ParkSender, &parkData);
+			return transfer.bSucceeded;
+		}
+
+		bool TrySend(const ElementType& element)
+		{
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			m_Waiters.Lock();
+			ETransferResult result = SendLocked(element, pWakeWaiters);
+			m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+			return result == ETR_Done;
+		}
+
+		// return false when the channel is closed and drained
+		bool Recv(ElementType& element)
+		{
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			m_Waiters.Lock();
+			ETransferResult result = RecvLocked(element, pWakeWaiters);
+			m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+
+			if (result != ETR_WouldBlock)
+				return result == ETR_Done;
+
+			// the channel is empty; suspend until the sender hands the element over
+			TransferData transfer = { &element, false };
+			H1FiberWaiter waiter;
+			waiter.Value = reinterpret_cast<intptr_t>(&transfer);
+			ParkData parkData = { this, &waiter };
+			H1FiberWaitQueue::Suspend(&waiter, ParkReceiver, &parkData);
+			return transfer.bSucceeded;
+		}
+
+		bool TryRecv(ElementType& element)
+		{
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			m_Waiters.Lock();
+			ETransferResult result = RecvLocked(element, pWakeWaiters);
+			m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+			return result == ETR_Done;
+		}
+
+		// send the elements as many as the channel takes under one lock, then suspend for the rest
+		//	- return the number of the sent elements (less than counts only when the channel is closed)
+		uint32_t SendBatch(const ElementType* elements, uint32_t counts)
+		{
+			uint32_t sentCounts = 0;
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			m_Waiters.Lock();
+			while (sentCounts < counts && SendLocked(elements[sentCounts], pWakeWaiters) == ETR_Done)
+				++sentCounts;
+			m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+
+			for (; sentCounts < counts; ++sentCounts)
+			{
+				if (!Send(elements[sentCounts]))
+					break;
+			}
+			return sentCounts;
+		}
+
+		// wait for at least one element, then take the available elements up to maxCounts under one lock
+		//	- return the number of the received elements (zero only when the channel is closed and drained)
+		uint32_t RecvBatch(ElementType* elements, uint32_t maxCounts)
+		{
+			if (maxCounts == 0 || !Recv(elements[0]))
+				return 0;
+
+			uint32_t receivedCounts = 1;
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			m_Waiters.Lock();
+			while (receivedCounts < maxCounts && RecvLocked(elements[receivedCounts], pWakeWaiters) == ETR_Done)
+				++receivedCounts;
+			m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+			return receivedCounts;
+		}
+
+		// fail the waiting senders and receivers; the buffered elements still could be received
+		void Close()
+		{
+			m_Waiters.Lock();
+			m_bClosed.store(true, std::memory_order_release);
+			// the transfer of each waiter is left as failed
+			H1FiberWaiter* pWaiters = m_Waiters.PopAll();
+			m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWaiters);
+		}
+
+		inline bool IsClosed() const { return m_bClosed.load(std::memory_order_acquire); }
+		inline uint32_t GetCapacity() const { return m_Capacity; }
+
+		uint32_t GetCounts()
+		{
+			m_Waiters.Lock();
+			uint32_t counts = m_Counts;
+			m_Waiters.Unlock();
+			return counts;
+		}
+
+	private:
+		enum ETransferResult
+		{
+			ETR_Done,
+			ETR_Closed,
+			ETR_WouldBlock,
+		};
+
+		// pointed by H1FiberWaiter::Value of the waiting sender/receiver
+		struct TransferData
+		{
+			ElementType* Element;
+			bool bSucceeded;
+		};
+
+		struct ParkData
+		{
+			H1FiberChannel* Channel;
+			H1FiberWaiter* Waiter;
+		};
+
+		// below methods require the lock; the waiters to wake are linked to pWakeWaiters (wake them after unlocking)
+		ETransferResult SendLocked(const ElementType& element, H1FiberWaiter*& pWakeWaiters)
+		{
+			if (m_bClosed.load(std::memory_order_relaxed))
+				return ETR_Closed;
+
+			// the buffer is empty and the receivers wait; hand the element over directly
+			if (m_Counts == 0 && !m_Waiters.IsEmpty())
+			{
+				H1FiberWaiter* pReceiver = m_Waiters.PopFront();
+				TransferData* pTransfer = reinterpret_cast<TransferData*>(pReceiver->Value);
+				*pTransfer->Element = element;
+				pTransfer->bSucceeded = true;
+				pReceiver->Next = pWakeWaiters;
+				pWakeWaiters = pReceiver;
+				return ETR_Done;
+			}
+
+			if (m_Counts == m_Capacity)
+				return ETR_WouldBlock;
+
+			m_Elements[GetIndex(m_Counts)] = element;
+			++m_Counts;
+			return ETR_Done;
+		}
+
+		ETransferResult RecvLocked(ElementType& element, H1FiberWaiter*& pWakeWaiters)
+		{
+			if (m_Counts == 0)
+				return m_bClosed.load(std::memory_order_relaxed) ? ETR_Closed : ETR_WouldBlock;
+
+			element = std::move(m_Elements[m_Head]);
+			m_Head = GetIndex(1);
+			--m_Counts;
+
+			// the buffer was full and the senders wait; move the element of the first sender into the freed slot
+			if (!m_Waiters.IsEmpty())
+			{
+				H1FiberWaiter* pSender = m_Waiters.PopFront();
+				TransferData* pTransfer = reinterpret_cast<TransferData*>(pSender->Value);
+				m_Elements[GetIndex(m_Counts)] = *pTransfer->Element;
+				++m_Counts;
+				pTransfer->bSucceeded = true;
+				pSender->Next = pWakeWaiters;
+				pWakeWaiters = pSender;
+			}
+			return ETR_Done;
+		}
+
+		inline uint32_t GetIndex(uint32_t offset) const
+		{
+			uint32_t index = m_Head + offset;
+			return index >= m_Capacity ? index - m_Capacity : index;
+		}
+
+		// the park callbacks retry the transfer with the lock held and register the waiter only when it still would block
+		static bool ParkSender(H1FiberContext* pFiberContext, void* pData)
+		{
+			ParkData* pParkData = reinterpret_cast<ParkData*>(pData);
+			H1FiberChannel* pChannel = pParkData->Channel;
+			H1FiberWaiter* pWaiter = pParkData->Waiter;
+			TransferData* pTransfer = reinterpret_cast<TransferData*>(pWaiter->Value);
+
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			pChannel->m_Waiters.Lock();
+			ETransferResult result = pChannel->SendLocked(*pTransfer->Element, pWakeWaiters);
+			if (result == ETR_WouldBlock)
+			{
+				pChannel->m_Waiters.PushBack(pWaiter);
+				pChannel->m_Waiters.Unlock();
+				return true;
+			}
+			pTransfer->bSucceeded = (result == ETR_Done);
+			pChannel->m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+			return false;
+		}
+
+		static bool ParkReceiver(H1FiberContext* pFiberContext, void* pData)
+		{
+			ParkData* pParkData = reinterpret_cast<ParkData*>(pData);
+			H1FiberChannel* pChannel = pParkData->Channel;
+			H1FiberWaiter* pWaiter = pParkData->Waiter;
+			TransferData* pTransfer = reinterpret_cast<TransferData*>(pWaiter->Value);
+
+			H1FiberWaiter* pWakeWaiters = nullptr;
+			pChannel->m_Waiters.Lock();
+			ETransferResult result = pChannel->RecvLocked(*pTransfer->Element, pWakeWaiters);
+			if (result == ETR_WouldBlock)
+			{
+				pChannel->m_Waiters.PushBack(pWaiter);
+				pChannel->m_Waiters.Unlock();
+				return true;
+			}
+			pTransfer->bSucceeded = (result == ETR_Done);
+			pChannel->m_Waiters.Unlock();
+			H1FiberWaitQueue::WakeAll(pWakeWaiters);
+			return false;
+		}
+
+		ElementType* m_Elements;
+		uint32_t m_Capacity;
+		// ring state protected by the lock of m_Waiters
+		uint32_t m_Head;
+		uint32_t m_Counts;
+		std::atomic<bool> m_bClosed;
+		H1FiberWaitQueue m_Waiters;
+	};
+}
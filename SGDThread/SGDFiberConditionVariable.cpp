@@ -0,0 +1,96 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDFiberConditionVariable.h"
+using namespace SGD;
+
+namespace
+{
+	struct H1FiberConditionVariableParkData
+	{
+		H1FiberConditionVariable* ConditionVariable;
+		H1FiberMutex* Mutex;
+		H1FiberWaiter* Waiter;
+	};
+}
+
+H1FiberConditionVariable::H1FiberConditionVariable()
+	: m_WaiterCounts(0)
+{
+
+}
+
+void H1FiberConditionVariable::Wait(H1FiberMutex& rMutex)
+{
+	H1FiberWaiter waiter;
+	H1FiberConditionVariableParkData parkData = { this, &rMutex, &waiter };
+	H1FiberWaitQueue::Suspend(&waiter, ParkOnConditionVariable, &parkData);
+
+	rMutex.Lock();
+}
+
+void H1FiberConditionVariable::NotifyOne()
+{
+	if (m_WaiterCounts.load(std::memory_order_acquire) == 0)
+		return;
+
+	m_Waiters.Lock();
+	H1FiberWaiter* pWaiter = m_Waiters.PopFront();
+	if (pWaiter != nullptr)
+		m_WaiterCounts.fetch_sub(1, std::memory_order_relaxed);
+	m_Waiters.Unlock();
+
+	if (pWaiter != nullptr)
+		H1FiberWaitQueue::Wake(pWaiter);
+}
+
+void H1FiberConditionVariable::NotifyAll()
+{
+	if (m_WaiterCounts.load(std::memory_order_acquire) == 0)
+		return;
+
+	m_Waiters.Lock();
+	H1FiberWaiter* pWaiters = m_Waiters.PopAll();
+	m_WaiterCounts.store(0, std::memory_order_relaxed);
+	m_Waiters.Unlock();
+
+	H1FiberWaitQueue::WakeAll(pWaiters);
+}
+
+bool H1FiberConditionVariable::ParkOnConditionVariable(H1FiberContext* pFiberContext, void* pData)
+{
+	H1FiberConditionVariableParkData* pParkData = reinterpret_cast<H1FiberConditionVariableParkData*>(pData);
+	// read the park data before registering; the notifier could resume the waiter right after (its stack could be gone)
+	H1FiberConditionVariable* pConditionVariable = pParkData->ConditionVariable;
+	H1FiberMutex* pMutex = pParkData->Mutex;
+
+	// register first, then unlock the mutex
+	pConditionVariable->m_Waiters.Lock();
+	pConditionVariable->m_Waiters.PushBack(pParkData->Waiter);
+	pConditionVariable->m_WaiterCounts.fetch_add(1, std::memory_order_release);
+	pConditionVariable->m_Waiters.Unlock();
+
+	pMutex->Unlock();
+	return true;
+}
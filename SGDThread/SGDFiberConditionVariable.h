@@ -0,0 +1,57 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDFiberMutex.h"
+
+namespace SGD
+{
+	// condition variable for H1FiberMutex suspending the fiber
+	//	- the waiter is registered before the mutex is unlocked, so the notification after the predicate is changed under the mutex is never lost
+	//	- Notify without the waiter costs one atomic load
+	//	- spurious wake-up is not generated, but check the predicate in the loop (or use the Wait with predicate) as usual
+	class H1FiberConditionVariable
+	{
+	public:
+		H1FiberConditionVariable();
+
+		// the mutex should be locked by the caller; it is locked again when it returns
+		void Wait(H1FiberMutex& rMutex);
+		template <typename PredicateType>
+		void Wait(H1FiberMutex& rMutex, PredicateType predicate)
+		{
+			while (!predicate())
+				Wait(rMutex);
+		}
+
+		void NotifyOne();
+		void NotifyAll();
+
+	private:
+		static bool ParkOnConditionVariable(H1FiberContext* pFiberContext, void* pData);
+
+		// the number of the registered waiters (read by Notify without the lock)
+		std::atomic<int32_t> m_WaiterCounts;
+		H1FiberWaitQueue m_Waiters;
+	};
+}
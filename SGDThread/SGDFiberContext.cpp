@@ -26,12 +26,24 @@
 #include "SGDWorkerThread.h"
 using namespace SGD;
 
+namespace
+{
+	// bit per allocated fiber-local slot
+	std::atomic<uint32_t> gAllocatedLocalSlotMask(0);
+	static_assert(H1FiberContext::MaxLocalSlotCounts <= 32, "the fiber-local slot masks have 32 bits");
+	std::atomic<FiberLocalCleanup> gLocalSlotCleanups[H1FiberContext::MaxLocalSlotCounts];
+}
+
 H1FiberContext::H1FiberContext()
 	: m_TaskSlot(nullptr)
 	, m_FiberInstance(nullptr)
 	, m_Index(-1)
 	, m_Owner(nullptr)
+	, m_ReadyLink(this)
+	, m_ScratchArena(nullptr)
+	, m_LocalValueMask(0)
 {
+	memset(m_LocalValues, 0, sizeof(m_LocalValues));
 
 }
 
@@ -58,6 +70,10 @@ void H1FiberContext::Destroy()
 	delete m_TaskCounter;
 	m_TaskCounter = nullptr;
 
+	// deallocate scratch arena
+	delete m_ScratchArena;
+	m_ScratchArena = nullptr;
+
 	// destroy fiber instance
 	DestroyFiberContext();
 }
@@ -76,6 +92,78 @@ void H1FiberContext::RunSlot()
 	m_TaskSlot->RunTask();
 }
 
+void H1FiberContext::ReleaseSlot()
+{
+	// the task slot is finished; detach it and the owner for later usage
+	m_TaskSlot = nullptr;
+	m_Owner = nullptr;
+
+	// temporaries of the finished task are freed at once
+	if (m_ScratchArena != nullptr)
+		m_ScratchArena->Reset();
+
+	// fiber-local values don't leak into the next task; only the slots set by the finished task are visited
+	while (m_LocalValueMask != 0)
+	{
+		FiberLocalSlot slot = 0;
+		while ((m_LocalValueMask & (1u << slot)) == 0)
+			++slot;
+		assert(slot < MaxLocalSlotCounts);
+		m_LocalValueMask &= ~(1u << slot);
+
+		void* value = m_LocalValues[slot];
+		m_LocalValues[slot] = nullptr;
+		FiberLocalCleanup cleanup = gLocalSlotCleanups[slot].load(std::memory_order_acquire);
+		if (value != nullptr && cleanup != nullptr)
+			cleanup(value);
+	}
+}
+
+FiberLocalSlot H1FiberContext::AllocateLocalSlot(FiberLocalCleanup cleanup)
+{
+	uint32_t allocatedMask = gAllocatedLocalSlotMask.load(std::memory_order_relaxed);
+	while (true)
+	{
+		FiberLocalSlot slot = 0;
+		while (slot < MaxLocalSlotCounts && (allocatedMask & (1u << slot)) != 0)
+			++slot;
+		if (slot == MaxLocalSlotCounts)
+			return InvalidLocalSlot;
+
+		// the slot is returned after the cleanup is set, so nobody sets the value of the slot before it
+		assert(slot < MaxLocalSlotCounts);
+		if (gAllocatedLocalSlotMask.compare_exchange_weak(allocatedMask, allocatedMask | (1u << slot)))
+		{
+			gLocalSlotCleanups[slot].store(cleanup, std::memory_order_release);
+			return slot;
+		}
+	}
+}
+
+void H1FiberContext::FreeLocalSlot(FiberLocalSlot slot)
+{
+	if (slot >= MaxLocalSlotCounts)
+	{
+		assert(false && "[invalid] the fiber-local slot is out of range");
+		return;
+	}
+	gAllocatedLocalSlotMask.fetch_and(~(1u << slot));
+}
+
+H1ScratchArena* H1FiberContext::GetScratchArena()
+{
+	if (m_ScratchArena == nullptr)
+	{
+		m_ScratchArena = new H1ScratchArena();
+		if (!m_ScratchArena->Initialize())
+		{
+			delete m_ScratchArena;
+			m_ScratchArena = nullptr;
+		}
+	}
+	return m_ScratchArena;
+}
+
 H1FiberContextWindow::H1FiberContextWindow()
 	: H1FiberContext()
 {
@@ -91,15 +179,19 @@ H1FiberContextWindow::~H1FiberContextWindow()
 // function body - entry point for fiber context
 void __stdcall H1FiberContextEntryPoint(void* Data)
 {
-	// run the task slot
 	H1FiberContext* fiberContext = reinterpret_cast<H1FiberContext*>(Data);
-	fiberContext->RunSlot();
-
-	// return to main thread, nullifying owner thread for later usage
-	H1WorkerThread* owner = fiberContext->GetOwner();
-	fiberContext->SetOwner(nullptr);
+	
+	// the fiber context is reused by the pool; never return from this function (it exits the thread)
+	while (true)
+	{
+		// run the task slot
+		fiberContext->RunSlot();
 
-	owner->SwitchThreadFiberContext();
+		// return to main thread; the owner thread releases this fiber context to the pool after leaving its stack
+		//	- when it is switched again with new task slot, it continues from here
+		H1WorkerThread* owner = fiberContext->GetOwner();
+		owner->ParkFiberContext(nullptr, nullptr);
+	}
 }
 #endif
 
@@ -164,10 +256,16 @@ bool H1FiberContextPool::Initialize()
 	}
 
 	// make free lists
+#if USE_BOUNDED_RING_QUEUE && !USE_MS_CONCURRENT_QUEUE
+	m_FreeFiberContexts[EFiberType::EFT_Small].Initialize(smallFiberContextCount);
+	m_FreeFiberContexts[EFiberType::EFT_Big].Initialize(bigFiberContextCount);
+#endif
 	for (int32_t i = 0; i < smallFiberContextCount; ++i)
 	{
 #if USE_MS_CONCURRENT_QUEUE
 		m_FreeFiberContexts[EFiberType::EFT_Small].push(i);
+#elif USE_BOUNDED_RING_QUEUE
+		m_FreeFiberContexts[EFiberType::EFT_Small].TryEnqueue(i);
 #else
 		m_FreeFiberContexts[EFiberType::EFT_Small].enqueue(i);
 #endif
@@ -177,6 +275,8 @@ bool H1FiberContextPool::Initialize()
 	{
 #if USE_MS_CONCURRENT_QUEUE
 		m_FreeFiberContexts[EFiberType::EFT_Big].push(i);
+#elif USE_BOUNDED_RING_QUEUE
+		m_FreeFiberContexts[EFiberType::EFT_Big].TryEnqueue(i);
 #else
 		m_FreeFiberContexts[EFiberType::EFT_Big].enqueue(i);
 #endif
@@ -207,6 +307,9 @@ bool H1FiberContextPool::EnqueueFreeFiberContext(FiberId fiberId, EFiberType fib
 {
 #if USE_MS_CONCURRENT_QUEUE
 	m_FreeFiberContexts[fiberType].push(fiberId);
+#elif USE_BOUNDED_RING_QUEUE
+	if (!m_FreeFiberContexts[fiberType].TryEnqueue(fiberId))
+		return false; // the fiber context is released twice
 #else
 	m_FreeFiberContexts[fiberType].enqueue(fiberId);
 #endif
@@ -218,6 +321,8 @@ FiberId H1FiberContextPool::DequeueFreeFiberContext(EFiberType fiberType)
 	FiberId result = -1;
 #if USE_MS_CONCURRENT_QUEUE
 	if (!m_FreeFiberContexts[fiberType].try_pop(result))
+#elif USE_BOUNDED_RING_QUEUE
+	if (!m_FreeFiberContexts[fiberType].TryDequeue(result))
 #else
 	if (!m_FreeFiberContexts[fiberType].try_dequeue(result))
 #endif
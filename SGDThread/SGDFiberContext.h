@@ -23,6 +23,10 @@
 
 #pragma once
 #include "SGDTask.h"
+#include "SGDScratchArena.h"
+#if USE_BOUNDED_RING_QUEUE
+#include "SGDBoundedQueue.h"
+#endif
 
 namespace SGD
 {
@@ -36,8 +40,26 @@ namespace SGD
 
 	typedef uint32_t FiberId;
 
+	// fiber-local storage slot (see H1FiberContext::AllocateLocalSlot)
+	typedef uint32_t FiberLocalSlot;
+	// called for the non-null value of the slot when the fiber returns to the pool
+	typedef void (*FiberLocalCleanup)(void* value);
+
 	// forward declaration
 	class H1WorkerThread;
+	class H1FiberContext;
+
+	// intrusive link of H1ReadyFiberContextQueue
+	struct H1ReadyFiberContextLink
+	{
+		H1ReadyFiberContextLink(H1FiberContext* fiberContext = nullptr)
+			: Next(nullptr)
+			, FiberContext(fiberContext)
+		{}
+
+		std::atomic<H1ReadyFiberContextLink*> Next;
+		H1FiberContext* FiberContext;
+	};
 
 	class H1FiberContext
 	{
@@ -50,6 +72,7 @@ namespace SGD
 
 		void SwitchSlot(H1TaskDeclaration* newSlot);
 		void RunSlot();
+		void ReleaseSlot();
 
 		// pure virtual functions to override in derived classes
 		virtual bool CreateFiberContext(int32_t stackSize) = 0;
@@ -64,9 +87,25 @@ namespace SGD
 		inline void* GetFiberInstance() const { return m_FiberInstance; }
 		inline H1TaskCounter* GetTaskCounter() { return m_TaskCounter; }
 		inline H1TaskDeclaration* GetTaskSlot() { return m_TaskSlot; }
+		// scratch arena for the task-body (lazily attached at first use, reset when the fiber returns to the pool)
+		H1ScratchArena* GetScratchArena();
+
+		// fiber-local storage; the value follows the task across the worker threads (unlike thread_local)
+		//	- the slots are shared by all fiber contexts; the values are reset to null when the fiber returns to the pool
+		//	  (the cleanup of the slot is called for the non-null value before it is reset)
+		static const uint32_t MaxLocalSlotCounts = 16;
+		static const FiberLocalSlot InvalidLocalSlot = FiberLocalSlot(-1);
+		// return InvalidLocalSlot when all slots are used
+		static FiberLocalSlot AllocateLocalSlot(FiberLocalCleanup cleanup = nullptr);
+		// NOTE THAT - the slot should not be used by any running fiber when it is freed
+		static void FreeLocalSlot(FiberLocalSlot slot);
+
+		inline void* GetLocalValue(FiberLocalSlot slot) const { assert(slot < MaxLocalSlotCounts && "[invalid] the fiber-local slot is out of range"); return m_LocalValues[slot]; }
+		inline void SetLocalValue(FiberLocalSlot slot, void* value) { assert(slot < MaxLocalSlotCounts && "[invalid] the fiber-local slot is out of range"); m_LocalValues[slot] = value; m_LocalValueMask |= (1u << slot); }
 		
 		inline H1WorkerThread* GetOwner() { return m_Owner; }
 		inline void SetOwner(H1WorkerThread* owner) { m_Owner = owner; }
+		inline H1ReadyFiberContextLink* GetReadyLink() { return &m_ReadyLink; }
 
 	protected:
 		// the index of fiber context pool
@@ -80,7 +119,15 @@ namespace SGD
 		// fiber instance
 		void* m_FiberInstance;
 		// worker thread holding this fiber-context
+		//	- it is kept while the fiber is suspended; the fiber is resumed by this worker thread preferably
 		H1WorkerThread* m_Owner;
+		// link of the ready-to-resume queue
+		H1ReadyFiberContextLink m_ReadyLink;
+		// scratch arena (null until it is used)
+		H1ScratchArena* m_ScratchArena;
+		// fiber-local values and the mask of the slots set since the fiber was taken from the pool
+		void* m_LocalValues[MaxLocalSlotCounts];
+		uint32_t m_LocalValueMask;
 	};
 
 	class H1FiberContextWindow : public H1FiberContext
@@ -126,6 +173,9 @@ namespace SGD
 		//	- please whenever modify this queues, please leave the place in comment
 #if USE_MS_CONCURRENT_QUEUE
 		concurrency::concurrent_queue<FiberId> m_FreeFiberContexts[EFiberType::EFT_Max];
+#elif USE_BOUNDED_RING_QUEUE
+		// the capacity is the number of fiber contexts; it is never full
+		H1BoundedQueue<FiberId> m_FreeFiberContexts[EFiberType::EFT_Max];
 #else
 		moodycamel::ConcurrentQueue<FiberId> m_FreeFiberContexts[EFiberType::EFT_Max];
 #endif
@@ -0,0 +1,122 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDFiberMutex.h"
+using namespace SGD;
+
+namespace
+{
+	struct H1FiberMutexParkData
+	{
+		H1FiberMutex* Mutex;
+		H1FiberWaiter* Waiter;
+	};
+}
+
+H1FiberMutex::H1FiberMutex()
+	: m_State(ELS_Unlocked)
+{
+
+}
+
+bool H1FiberMutex::TryLock()
+{
+	int32_t expected = ELS_Unlocked;
+	return m_State.compare_exchange_strong(expected, ELS_Locked, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void H1FiberMutex::Lock()
+{
+	if (TryLock())
+		return;
+
+	// the critical section is usually short; spin briefly before paying for the fiber switch
+	for (int32_t i = 0; i < SpinCounts; ++i)
+	{
+		appYieldProcessor();
+		if (m_State.load(std::memory_order_relaxed) == ELS_Unlocked && TryLock())
+			return;
+	}
+
+	// when it returns, the lock is handed off by Unlock (or acquired while registering the waiter)
+	H1FiberWaiter waiter;
+	H1FiberMutexParkData parkData = { this, &waiter };
+	H1FiberWaitQueue::Suspend(&waiter, ParkOnMutex, &parkData);
+}
+
+void H1FiberMutex::Unlock()
+{
+	int32_t expected = ELS_Locked;
+	if (m_State.compare_exchange_strong(expected, ELS_Unlocked, std::memory_order_release, std::memory_order_relaxed))
+		return; // no waiter
+
+	// hand off the lock to the first waiter; the state stays locked
+	m_Waiters.Lock();
+	H1FiberWaiter* pWaiter = m_Waiters.PopFront();
+	if (m_Waiters.IsEmpty())
+		m_State.store(ELS_Locked, std::memory_order_relaxed);
+	m_Waiters.Unlock();
+
+	assert(pWaiter != nullptr && "[invalid] the state with waiters should have the waiter");
+	H1FiberWaitQueue::Wake(pWaiter);
+}
+
+bool H1FiberMutex::ParkOnMutex(H1FiberContext* pFiberContext, void* pData)
+{
+	H1FiberMutexParkData* pParkData = reinterpret_cast<H1FiberMutexParkData*>(pData);
+	return pParkData->Mutex->RegisterWaiter(pParkData->Waiter);
+}
+
+bool H1FiberMutex::RegisterWaiter(H1FiberWaiter* pWaiter)
+{
+	m_Waiters.Lock();
+
+	// the state is changed to 'with waiters' while the waiter list is locked, so Unlock always finds the waiter
+	int32_t state = m_State.load(std::memory_order_relaxed);
+	while (true)
+	{
+		if (state == ELS_Unlocked)
+		{
+			if (m_State.compare_exchange_weak(state, ELS_Locked, std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				// the holder released it in the meantime; take it and resume immediately
+				m_Waiters.Unlock();
+				return false;
+			}
+		}
+		else if (state == ELS_Locked)
+		{
+			if (m_State.compare_exchange_weak(state, ELS_LockedWithWaiters, std::memory_order_relaxed))
+				break;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	m_Waiters.PushBack(pWaiter);
+	m_Waiters.Unlock();
+	return true;
+}
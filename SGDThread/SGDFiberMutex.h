@@ -0,0 +1,75 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDFiberWaitQueue.h"
+
+namespace SGD
+{
+	// mutex suspending the fiber instead of blocking the worker thread
+	//	- it spins briefly, then parks the fiber on the intrusive waiter list and switches to other work
+	//	- Unlock hands off the lock to the first waiter directly (FIFO; no barging while waiters exist)
+	//	- the holder could suspend (e.g. WaitForCounter) while it holds the lock; other fibers on the same worker thread still run
+	//	- the thread which is not the fiber (e.g. main thread) spins instead of suspending
+	class H1FiberMutex
+	{
+	public:
+		// the number of trials before suspending the fiber
+		static const int32_t SpinCounts = 64;
+
+		H1FiberMutex();
+
+		void Lock();
+		bool TryLock();
+		void Unlock();
+
+	private:
+		enum ELockState
+		{
+			ELS_Unlocked,
+			ELS_Locked,
+			ELS_LockedWithWaiters, // Unlock should look up the waiter list
+		};
+
+		static bool ParkOnMutex(H1FiberContext* pFiberContext, void* pData);
+		// register the waiter or acquire the lock when it is already unlocked (return false)
+		bool RegisterWaiter(H1FiberWaiter* pWaiter);
+
+		std::atomic<int32_t> m_State;
+		H1FiberWaitQueue m_Waiters;
+	};
+
+	// scoped lock for H1FiberMutex
+	class H1FiberMutexScope
+	{
+	public:
+		explicit H1FiberMutexScope(H1FiberMutex& rMutex) : m_Mutex(rMutex) { m_Mutex.Lock(); }
+		~H1FiberMutexScope() { m_Mutex.Unlock(); }
+
+	private:
+		H1FiberMutexScope(const H1FiberMutexScope&) = delete;
+		H1FiberMutexScope& operator=(const H1FiberMutexScope&) = delete;
+
+		H1FiberMutex& m_Mutex;
+	};
+}
@@ -0,0 +1,182 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDFiberReaderWriterLock.h"
+using namespace SGD;
+
+namespace
+{
+	struct H1FiberReaderWriterLockParkData
+	{
+		H1FiberReaderWriterLock* Lock;
+		H1FiberWaiter* Waiter;
+	};
+}
+
+H1FiberReaderWriterLock::H1FiberReaderWriterLock(uint32_t readerSlotCounts)
+	: m_ReaderSlots(nullptr)
+	, m_ReaderSlotCounts(readerSlotCounts != 0 ? readerSlotCounts : appGetNumHardwareThreads() + 1)
+	, m_WriterCounts(0)
+{
+	// operator new doesn't over-align before C++17
+	m_ReaderSlots = reinterpret_cast<H1ReaderSlot*>(appAllocateAlignedMemory(sizeof(H1ReaderSlot) * m_ReaderSlotCounts, alignof(H1ReaderSlot)));
+	assert(m_ReaderSlots != nullptr);
+	for (uint32_t i = 0; i < m_ReaderSlotCounts; ++i)
+	{
+		new (&m_ReaderSlots[i]) H1ReaderSlot();
+		m_ReaderSlots[i].ReaderCounts.store(0, std::memory_order_relaxed);
+	}
+}
+
+H1FiberReaderWriterLock::~H1FiberReaderWriterLock()
+{
+	for (uint32_t i = 0; i < m_ReaderSlotCounts; ++i)
+		m_ReaderSlots[i].~H1ReaderSlot();
+	appFreeAlignedMemory(m_ReaderSlots);
+	m_ReaderSlots = nullptr;
+}
+
+uint32_t H1FiberReaderWriterLock::GetCurrentReaderSlot() const
+{
+	// the last slot is shared by the threads which are not the worker thread
+	H1WorkerThread* pWorkerThread = H1WorkerThread::GetCurrentWorkerThread();
+	if (pWorkerThread == nullptr || m_ReaderSlotCounts == 1)
+		return m_ReaderSlotCounts - 1;
+	return static_cast<uint32_t>(pWorkerThread->GetWorkerThreadIndex()) % (m_ReaderSlotCounts - 1);
+}
+
+bool H1FiberReaderWriterLock::IsReaderDrained() const
+{
+	for (uint32_t i = 0; i < m_ReaderSlotCounts; ++i)
+	{
+		if (m_ReaderSlots[i].ReaderCounts.load() != 0)
+			return false;
+	}
+	return true;
+}
+
+uint32_t H1FiberReaderWriterLock::LockShared()
+{
+	uint32_t readerSlot = GetCurrentReaderSlot();
+	while (true)
+	{
+		// count in first, then check the writers (the writer announces itself first, then checks the readers)
+		m_ReaderSlots[readerSlot].ReaderCounts.fetch_add(1);
+		if (m_WriterCounts.load() == 0)
+			return readerSlot;
+
+		// back off for the writer
+		m_ReaderSlots[readerSlot].ReaderCounts.fetch_sub(1);
+		WakeDrainedWriter();
+
+		// wait until all writers leave, then try again
+		H1FiberWaiter waiter;
+		H1FiberReaderWriterLockParkData parkData = { this, &waiter };
+		H1FiberWaitQueue::Suspend(&waiter, ParkReader, &parkData);
+
+		// the fiber could be resumed in other worker thread
+		readerSlot = GetCurrentReaderSlot();
+	}
+}
+
+void H1FiberReaderWriterLock::UnlockShared(uint32_t readerSlot)
+{
+	m_ReaderSlots[readerSlot].ReaderCounts.fetch_sub(1);
+	if (m_WriterCounts.load() != 0)
+		WakeDrainedWriter();
+}
+
+void H1FiberReaderWriterLock::Lock()
+{
+	// announce the writer first; new readers back off from now on
+	m_WriterCounts.fetch_add(1);
+	m_WriterMutex.Lock();
+
+	// wait for the readers in the critical section
+	if (IsReaderDrained())
+		return;
+
+	H1FiberWaiter waiter;
+	H1FiberReaderWriterLockParkData parkData = { this, &waiter };
+	H1FiberWaitQueue::Suspend(&waiter, ParkWriter, &parkData);
+}
+
+void H1FiberReaderWriterLock::Unlock()
+{
+	m_WriterMutex.Unlock();
+	if (m_WriterCounts.fetch_sub(1) != 1)
+		return; // the next writer goes first
+
+	// the last writer releases the readers backed off at once
+	m_ReaderWaiters.Lock();
+	H1FiberWaiter* pWaiters = m_ReaderWaiters.PopAll();
+	m_ReaderWaiters.Unlock();
+	H1FiberWaitQueue::WakeAll(pWaiters);
+}
+
+void H1FiberReaderWriterLock::WakeDrainedWriter()
+{
+	m_WriterWaiters.Lock();
+	H1FiberWaiter* pWaiter = nullptr;
+	if (!m_WriterWaiters.IsEmpty() && IsReaderDrained())
+		pWaiter = m_WriterWaiters.PopFront();
+	m_WriterWaiters.Unlock();
+
+	if (pWaiter != nullptr)
+		H1FiberWaitQueue::Wake(pWaiter);
+}
+
+bool H1FiberReaderWriterLock::ParkReader(H1FiberContext* pFiberContext, void* pData)
+{
+	H1FiberReaderWriterLockParkData* pParkData = reinterpret_cast<H1FiberReaderWriterLockParkData*>(pData);
+	H1FiberReaderWriterLock* pLock = pParkData->Lock;
+
+	pLock->m_ReaderWaiters.Lock();
+	// the last writer left already; try again right now
+	if (pLock->m_WriterCounts.load() == 0)
+	{
+		pLock->m_ReaderWaiters.Unlock();
+		return false;
+	}
+	pLock->m_ReaderWaiters.PushBack(pParkData->Waiter);
+	pLock->m_ReaderWaiters.Unlock();
+	return true;
+}
+
+bool H1FiberReaderWriterLock::ParkWriter(H1FiberContext* pFiberContext, void* pData)
+{
+	H1FiberReaderWriterLockParkData* pParkData = reinterpret_cast<H1FiberReaderWriterLockParkData*>(pData);
+	H1FiberReaderWriterLock* pLock = pParkData->Lock;
+
+	pLock->m_WriterWaiters.Lock();
+	// the readers left already; the writer holds the lock
+	if (pLock->IsReaderDrained())
+	{
+		pLock->m_WriterWaiters.Unlock();
+		return false;
+	}
+	pLock->m_WriterWaiters.PushBack(pParkData->Waiter);
+	pLock->m_WriterWaiters.Unlock();
+	return true;
+}
@@ -0,0 +1,101 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDFiberMutex.h"
+
+namespace SGD
+{
+	// reader-writer lock suspending the fiber (for read-mostly shared states)
+	//	- readers count themselves in the per-worker slot (on own cache line), so concurrent readers don't bounce one line
+	//	- writer preference: new readers back off while any writer is waiting or holding the lock
+	//	- writers are serialized by H1FiberMutex; the writer holding it waits until the reader slots are drained
+	//	- LockShared returns the reader slot; pass it to UnlockShared (the fiber could be resumed in other worker thread while it reads)
+	//	- NOTE THAT - recursive read lock could deadlock with the waiting writer (same as other writer-preferring locks)
+	class H1FiberReaderWriterLock
+	{
+	public:
+		// readerSlotCounts 0 means one slot per hardware thread plus one for the threads which are not the worker thread
+		explicit H1FiberReaderWriterLock(uint32_t readerSlotCounts = 0);
+		~H1FiberReaderWriterLock();
+
+		uint32_t LockShared();
+		void UnlockShared(uint32_t readerSlot);
+
+		void Lock();
+		void Unlock();
+
+	private:
+		// own cache line per slot (the array is allocated with the alignment)
+		struct alignas(64) H1ReaderSlot
+		{
+			std::atomic<int32_t> ReaderCounts;
+		};
+
+		static bool ParkReader(H1FiberContext* pFiberContext, void* pData);
+		static bool ParkWriter(H1FiberContext* pFiberContext, void* pData);
+
+		uint32_t GetCurrentReaderSlot() const;
+		bool IsReaderDrained() const;
+		// wake the writer waiting for the readers, when the last reader leaves
+		void WakeDrainedWriter();
+
+		H1ReaderSlot* m_ReaderSlots;
+		uint32_t m_ReaderSlotCounts;
+		// the number of writers waiting or holding the lock
+		std::atomic<int32_t> m_WriterCounts;
+		// serialize writers
+		H1FiberMutex m_WriterMutex;
+		// readers backed off by the writers, and the writer waiting for the readers
+		H1FiberWaitQueue m_ReaderWaiters;
+		H1FiberWaitQueue m_WriterWaiters;
+	};
+
+	// scoped locks for H1FiberReaderWriterLock
+	class H1FiberReadScope
+	{
+	public:
+		explicit H1FiberReadScope(H1FiberReaderWriterLock& rLock) : m_Lock(rLock), m_ReaderSlot(rLock.LockShared()) {}
+		~H1FiberReadScope() { m_Lock.UnlockShared(m_ReaderSlot); }
+
+	private:
+		H1FiberReadScope(const H1FiberReadScope&) = delete;
+		H1FiberReadScope& operator=(const H1FiberReadScope&) = delete;
+
+		H1FiberReaderWriterLock& m_Lock;
+		uint32_t m_ReaderSlot;
+	};
+
+	class H1FiberWriteScope
+	{
+	public:
+		explicit H1FiberWriteScope(H1FiberReaderWriterLock& rLock) : m_Lock(rLock) { m_Lock.Lock(); }
+		~H1FiberWriteScope() { m_Lock.Unlock(); }
+
+	private:
+		H1FiberWriteScope(const H1FiberWriteScope&) = delete;
+		H1FiberWriteScope& operator=(const H1FiberWriteScope&) = delete;
+
+		H1FiberReaderWriterLock& m_Lock;
+	};
+}
@@ -0,0 +1,117 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDFiberSemaphore.h"
+using namespace SGD;
+
+namespace
+{
+	struct H1FiberSemaphoreParkData
+	{
+		H1FiberSemaphore* Semaphore;
+		H1FiberWaiter* Waiter;
+	};
+}
+
+H1FiberSemaphore::H1FiberSemaphore(int32_t initialCounts)
+	: m_Counts(initialCounts)
+	, m_PendingWakeCounts(0)
+{
+
+}
+
+void H1FiberSemaphore::Acquire()
+{
+	// the permit is taken (or the waiter is reserved) by one decrement
+	if (m_Counts.fetch_sub(1, std::memory_order_acquire) > 0)
+		return;
+
+	// the permit is passed by Release when it returns
+	H1FiberWaiter waiter;
+	H1FiberSemaphoreParkData parkData = { this, &waiter };
+	H1FiberWaitQueue::Suspend(&waiter, ParkOnSemaphore, &parkData);
+}
+
+bool H1FiberSemaphore::TryAcquire()
+{
+	int32_t counts = m_Counts.load(std::memory_order_relaxed);
+	while (counts > 0)
+	{
+		if (m_Counts.compare_exchange_weak(counts, counts - 1, std::memory_order_acquire, std::memory_order_relaxed))
+			return true;
+	}
+	return false;
+}
+
+void H1FiberSemaphore::Release(int32_t counts)
+{
+	int32_t prevCounts = m_Counts.fetch_add(counts, std::memory_order_release);
+	if (prevCounts >= 0)
+		return; // no waiter
+
+	// pass the permits to the waiters directly
+	int32_t wakeCounts = std::min(counts, -prevCounts);
+	H1FiberWaiter* pWaiters = nullptr;
+	H1FiberWaiter* pLastWaiter = nullptr;
+	m_Waiters.Lock();
+	for (int32_t i = 0; i < wakeCounts; ++i)
+	{
+		H1FiberWaiter* pWaiter = m_Waiters.PopFront();
+		if (pWaiter == nullptr)
+		{
+			// the rest of the waiters decremented the counter, but they are not registered yet
+			m_PendingWakeCounts += wakeCounts - i;
+			break;
+		}
+		if (pLastWaiter == nullptr)
+			pWaiters = pWaiter;
+		else
+			pLastWaiter->Next = pWaiter;
+		pLastWaiter = pWaiter;
+	}
+	m_Waiters.Unlock();
+
+	H1FiberWaitQueue::WakeAll(pWaiters);
+}
+
+bool H1FiberSemaphore::ParkOnSemaphore(H1FiberContext* pFiberContext, void* pData)
+{
+	H1FiberSemaphoreParkData* pParkData = reinterpret_cast<H1FiberSemaphoreParkData*>(pData);
+	return pParkData->Semaphore->RegisterWaiter(pParkData->Waiter);
+}
+
+bool H1FiberSemaphore::RegisterWaiter(H1FiberWaiter* pWaiter)
+{
+	m_Waiters.Lock();
+	if (m_PendingWakeCounts > 0)
+	{
+		// the permit is already released for this waiter
+		--m_PendingWakeCounts;
+		m_Waiters.Unlock();
+		return false;
+	}
+	m_Waiters.PushBack(pWaiter);
+	m_Waiters.Unlock();
+	return true;
+}
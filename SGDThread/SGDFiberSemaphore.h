@@ -0,0 +1,55 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDFiberWaitQueue.h"
+
+namespace SGD
+{
+	// counting semaphore suspending the fiber while there is no permit
+	//	- the counter is the number of permits, or the negative number of waiters
+	//	- Acquire with a permit and Release without the waiter cost one atomic operation
+	//	- Release racing with the waiter which is not registered yet leaves the pending wake-up; the waiter consumes it instead of suspending
+	class H1FiberSemaphore
+	{
+	public:
+		explicit H1FiberSemaphore(int32_t initialCounts = 0);
+
+		void Acquire();
+		bool TryAcquire();
+		void Release(int32_t counts = 1);
+
+		// the number of permits (negative when the fibers are waiting); only for the diagnostics
+		inline int32_t GetCounts() const { return m_Counts.load(std::memory_order_relaxed); }
+
+	private:
+		static bool ParkOnSemaphore(H1FiberContext* pFiberContext, void* pData);
+		// register the waiter or consume the pending wake-up (return false)
+		bool RegisterWaiter(H1FiberWaiter* pWaiter);
+
+		std::atomic<int32_t> m_Counts;
+		// the wake-ups released before the waiters are registered (protected by the lock of m_Waiters)
+		int32_t m_PendingWakeCounts;
+		H1FiberWaitQueue m_Waiters;
+	};
+}
@@ -0,0 +1,125 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDFiberWaitQueue.h"
+#include "SGDTaskScheduler.h"
+using namespace SGD;
+
+H1FiberWaiter::H1FiberWaiter()
+	: FiberContext(H1TaskSchedulerLayer::GetCurrentFiberContext())
+	, Next(nullptr)
+	, bSignaled(false)
+	, Value(0)
+{
+
+}
+
+H1FiberWaitQueue::H1FiberWaitQueue()
+	: m_bLocked(false)
+	, m_Head(nullptr)
+	, m_Tail(nullptr)
+{
+
+}
+
+void H1FiberWaitQueue::Lock()
+{
+	while (m_bLocked.exchange(true, std::memory_order_acquire))
+	{
+		// spin on the load not to bounce the cache line
+		while (m_bLocked.load(std::memory_order_relaxed))
+			appYieldProcessor();
+	}
+}
+
+void H1FiberWaitQueue::Unlock()
+{
+	m_bLocked.store(false, std::memory_order_release);
+}
+
+void H1FiberWaitQueue::PushBack(H1FiberWaiter* pWaiter)
+{
+	pWaiter->Next = nullptr;
+	if (m_Tail == nullptr)
+		m_Head = pWaiter;
+	else
+		m_Tail->Next = pWaiter;
+	m_Tail = pWaiter;
+}
+
+H1FiberWaiter* H1FiberWaitQueue::PopFront()
+{
+	H1FiberWaiter* pWaiter = m_Head;
+	if (pWaiter == nullptr)
+		return nullptr;
+
+	m_Head = pWaiter->Next;
+	if (m_Head == nullptr)
+		m_Tail = nullptr;
+	pWaiter->Next = nullptr;
+	return pWaiter;
+}
+
+H1FiberWaiter* H1FiberWaitQueue::PopAll()
+{
+	H1FiberWaiter* pWaiters = m_Head;
+	m_Head = nullptr;
+	m_Tail = nullptr;
+	return pWaiters;
+}
+
+void H1FiberWaitQueue::Suspend(H1FiberWaiter* pWaiter, FiberContextParkCallback callback, void* data)
+{
+	if (pWaiter->FiberContext != nullptr)
+	{
+		H1TaskSchedulerLayer::SuspendCurrentFiber(callback, data);
+		return;
+	}
+
+	// not the fiber (e.g. main thread); register in place and spin until it is woken
+	if (!callback(nullptr, data))
+		return;
+	while (!pWaiter->bSignaled.load(std::memory_order_acquire))
+		appYieldProcessor();
+}
+
+void H1FiberWaitQueue::Wake(H1FiberWaiter* pWaiter)
+{
+	H1FiberContext* pFiberContext = pWaiter->FiberContext;
+	if (pFiberContext != nullptr)
+		H1TaskSchedulerLayer::ResumeFiber(pFiberContext);
+	else
+		pWaiter->bSignaled.store(true, std::memory_order_release);
+}
+
+void H1FiberWaitQueue::WakeAll(H1FiberWaiter* pWaiters)
+{
+	while (pWaiters != nullptr)
+	{
+		// get next before waking up; the waiter could be gone right after
+		H1FiberWaiter* pNextWaiter = pWaiters->Next;
+		Wake(pWaiters);
+		pWaiters = pNextWaiter;
+	}
+}
@@ -0,0 +1,80 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDWorkerThread.h"
+
+namespace SGD
+{
+	// waiter blocked on the fiber synchronization primitive (H1FiberMutex, H1FiberSemaphore, ...)
+	//	- it lives on the stack of the waiting fiber (the stack is kept while the fiber is suspended), so no allocation
+	//	- the waiter which is not the fiber (e.g. main thread) spins on bSignaled instead of suspending
+	struct H1FiberWaiter
+	{
+		H1FiberWaiter();
+
+		// null when the waiter is not the fiber
+		H1FiberContext* FiberContext;
+		// intrusive link of H1FiberWaitQueue
+		H1FiberWaiter* Next;
+		// set by Wake for the waiter which is not the fiber
+		std::atomic<bool> bSignaled;
+		// payload owned by the primitive (e.g. reader/writer, the result of the wait)
+		intptr_t Value;
+	};
+
+	// intrusive FIFO list of the waiters protected by spin-lock
+	//	- the lock is held only to link/unlink the waiters; never hold it across suspending the fiber
+	//	- the primitive registers the waiter in the park callback (after the fiber left its stack) with the lock held,
+	//	  so the waker never resumes the fiber which is still running
+	class H1FiberWaitQueue
+	{
+	public:
+		H1FiberWaitQueue();
+
+		void Lock();
+		void Unlock();
+
+		// below methods require the lock
+		void PushBack(H1FiberWaiter* pWaiter);
+		H1FiberWaiter* PopFront();
+		// detach all waiters at once (linked by Next in FIFO order)
+		H1FiberWaiter* PopAll();
+		inline H1FiberWaiter* GetFront() const { return m_Head; }
+		inline bool IsEmpty() const { return m_Head == nullptr; }
+
+		// suspend the caller; the callback registers the waiter (see FiberContextParkCallback)
+		//	- the waiter which is not the fiber runs the callback in place and spins until it is woken
+		static void Suspend(H1FiberWaiter* pWaiter, FiberContextParkCallback callback, void* data);
+		// resume the waiter removed from the queue; call it after unlocking the queue
+		//	- NOTE THAT - don't touch the waiter after this call (its stack could be gone)
+		static void Wake(H1FiberWaiter* pWaiter);
+		// wake the waiters detached by PopAll
+		static void WakeAll(H1FiberWaiter* pWaiters);
+
+	private:
+		std::atomic<bool> m_bLocked;
+		H1FiberWaiter* m_Head;
+		H1FiberWaiter* m_Tail;
+	};
+}
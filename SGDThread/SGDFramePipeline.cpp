@@ -0,0 +1,132 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDFramePipeline.h"
+#include "SGDTaskScheduler.h"
+using namespace SGD;
+
+H1FrameContext::H1FrameContext()
+	: m_FrameIndex(0)
+	, m_bSubmitting(false)
+{
+
+}
+
+H1FramePipeline::H1FramePipeline()
+	: m_PipelineDepth(0)
+	, m_FrameContexts(nullptr)
+	, m_NextFrameIndex(0)
+{
+
+}
+
+H1FramePipeline::~H1FramePipeline()
+{
+	Destroy();
+}
+
+bool H1FramePipeline::Initialize(int32_t pipelineDepth)
+{
+	if (pipelineDepth <= 0)
+		return false;
+
+	m_PipelineDepth = pipelineDepth;
+	m_FrameContexts = new H1FrameContext[pipelineDepth];
+	m_NextFrameIndex = 0;
+
+	return true;
+}
+
+void H1FramePipeline::Destroy()
+{
+	if (m_FrameContexts == nullptr)
+		return;
+
+	// frame contexts could be referenced by tasks in flight
+	Flush();
+
+	delete[] m_FrameContexts;
+	m_FrameContexts = nullptr;
+	m_PipelineDepth = 0;
+}
+
+H1FrameContext* H1FramePipeline::BeginFrame()
+{
+	H1FrameContext* pFrameContext = &m_FrameContexts[m_NextFrameIndex % m_PipelineDepth];
+	assert(!pFrameContext->m_bSubmitting && "[invalid] the previous frame in this slot is not ended");
+
+	// back-pressure - wait for the frame (N - depth) in the same slot to retire
+	H1TaskSchedulerLayer::WaitForCounter(pFrameContext->GetTaskCounter());
+
+	pFrameContext->m_FrameIndex = m_NextFrameIndex++;
+	pFrameContext->m_bSubmitting = true;
+	// hold the frame open until EndFrame
+	pFrameContext->m_TaskCounter.FetchAndAdd(1);
+
+	return pFrameContext;
+}
+
+void H1FramePipeline::EndFrame(H1FrameContext* pFrameContext)
+{
+	assert(pFrameContext->m_bSubmitting && "[invalid] the frame is not began");
+	pFrameContext->m_bSubmitting = false;
+
+	// release the count holding the frame; the last finished task (or this) retires the frame
+	pFrameContext->m_TaskCounter.Release();
+}
+
+bool H1FramePipeline::RunTasks(H1FrameContext* pFrameContext, H1TaskDeclaration* tasks, int32_t taskCounts)
+{
+	return H1TaskSchedulerLayer::RunTasksWithCounter(tasks, taskCounts, pFrameContext->GetTaskCounter());
+}
+
+bool H1FramePipeline::RunTasksOnRetire(H1FrameContext* pFrameContext, H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter* pTaskCounter)
+{
+	return H1TaskSchedulerLayer::RunTasksAfter(pFrameContext->GetTaskCounter(), tasks, taskCounts, pTaskCounter);
+}
+
+bool H1FramePipeline::WaitForFrame(H1FrameContext* pFrameContext)
+{
+	return H1TaskSchedulerLayer::WaitForCounter(pFrameContext->GetTaskCounter());
+}
+
+void H1FramePipeline::Flush()
+{
+	for (int32_t i = 0; i < m_PipelineDepth; ++i)
+		WaitForFrame(&m_FrameContexts[i]);
+}
+
+bool H1FramePipeline::IsFrameRetired(uint64_t frameIndex)
+{
+	// not started yet
+	if (frameIndex >= m_NextFrameIndex)
+		return false;
+
+	// the slot is already reused by later frame
+	H1FrameContext* pFrameContext = &m_FrameContexts[frameIndex % m_PipelineDepth];
+	if (pFrameContext->m_FrameIndex != frameIndex)
+		return true;
+
+	return pFrameContext->m_TaskCounter.Get() == 0;
+}
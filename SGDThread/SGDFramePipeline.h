@@ -0,0 +1,90 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDTask.h"
+
+namespace SGD
+{
+	// task group of one frame in flight
+	//	- every task of the frame is bound to the frame's task counter (instead of the counter of the calling fiber)
+	//	- the frame holds one extra count until EndFrame(), so the frame never retires while it is still submitting tasks
+	class H1FrameContext
+	{
+	public:
+		H1FrameContext();
+
+		inline uint64_t GetFrameIndex() const { return m_FrameIndex; }
+		inline H1TaskCounter* GetTaskCounter() { return &m_TaskCounter; }
+		inline bool IsSubmitting() const { return m_bSubmitting; }
+
+	private:
+		friend class H1FramePipeline;
+
+		uint64_t m_FrameIndex;
+		H1TaskCounter m_TaskCounter;
+		// between BeginFrame and EndFrame
+		bool m_bSubmitting;
+	};
+
+	// multiple frames in flight (e.g. game logic of frame N+1 runs while render tasks of frame N finish)
+	//	- frame contexts are recycled in ring buffer with the size of pipeline depth
+	//	- BeginFrame of frame N+depth blocks until frame N retires (back-pressure)
+	//	- BeginFrame/EndFrame are called by one thread (or fiber) owning the frame loop
+	class H1FramePipeline
+	{
+	public:
+		H1FramePipeline();
+		~H1FramePipeline();
+
+		bool Initialize(int32_t pipelineDepth);
+		void Destroy();
+
+		// start next frame; the calling fiber is suspended (main thread spins) while the frame in the same slot is in flight
+		H1FrameContext* BeginFrame();
+		// finish submitting tasks of the frame; the frame retires when all of its tasks finish
+		void EndFrame(H1FrameContext* pFrameContext);
+
+		// run tasks as the part of the frame (could be called in the tasks of the frame to extend it)
+		bool RunTasks(H1FrameContext* pFrameContext, H1TaskDeclaration* tasks, int32_t taskCounts);
+		// run tasks when the frame retires (e.g. releasing resources of the frame)
+		//	- they are enqueued when the frame retires, so they could still run after the slot is reused (use pTaskCounter to wait them)
+		bool RunTasksOnRetire(H1FrameContext* pFrameContext, H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter* pTaskCounter = nullptr);
+		// wait for the frame to retire
+		//	- NOTE THAT - only one fiber could wait for the frame at once (BeginFrame waits for the frame in the same slot)
+		bool WaitForFrame(H1FrameContext* pFrameContext);
+		// wait for all frames in flight to retire
+		void Flush();
+
+		// called by the owner of the frame loop
+		bool IsFrameRetired(uint64_t frameIndex);
+		inline int32_t GetPipelineDepth() const { return m_PipelineDepth; }
+		inline uint64_t GetNextFrameIndex() const { return m_NextFrameIndex; }
+
+	private:
+		int32_t m_PipelineDepth;
+		// frame contexts in ring buffer (indexed by frame index % pipeline depth)
+		H1FrameContext* m_FrameContexts;
+		uint64_t m_NextFrameIndex;
+	};
+}
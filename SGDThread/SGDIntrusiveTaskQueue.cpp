@@ -0,0 +1,128 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDIntrusiveTaskQueue.h"
+using namespace SGD;
+
+H1IntrusiveTaskQueue::H1IntrusiveTaskQueue()
+	: m_Inbound(nullptr)
+	, m_Outbound(0)
+{
+
+}
+
+H1IntrusiveTaskQueue::~H1IntrusiveTaskQueue()
+{
+
+}
+
+bool H1IntrusiveTaskQueue::EnqueueTask(H1TaskDeclaration* pTask)
+{
+	return EnqueueTaskList(pTask, pTask);
+}
+
+bool H1IntrusiveTaskQueue::EnqueueTaskRange(H1TaskDeclaration* tasks, int32_t taskCounts)
+{
+	if (taskCounts <= 0)
+		return true;
+
+	// the inbound stack is the newest first; link the array in reverse order
+	for (int32_t taskIdx = taskCounts - 1; taskIdx > 0; --taskIdx)
+		tasks[taskIdx].SetQueueNext(&tasks[taskIdx - 1]);
+
+	return EnqueueTaskList(&tasks[taskCounts - 1], &tasks[0]);
+}
+
+bool H1IntrusiveTaskQueue::EnqueueTaskList(H1TaskDeclaration* pNewestTask, H1TaskDeclaration* pOldestTask)
+{
+	H1TaskDeclaration* pHead = m_Inbound.load(std::memory_order_relaxed);
+	do
+	{
+		pOldestTask->SetQueueNext(pHead);
+	} while (!m_Inbound.compare_exchange_weak(pHead, pNewestTask, std::memory_order_release, std::memory_order_relaxed));
+
+	return true;
+}
+
+void H1IntrusiveTaskQueue::SpliceOutbound(H1TaskDeclaration* pFirstTask, H1TaskDeclaration* pLastTask)
+{
+	TaggedPointer outbound = m_Outbound.load(std::memory_order_relaxed);
+	do
+	{
+		pLastTask->SetQueueNext(UnpackPointer(outbound));
+	} while (!m_Outbound.compare_exchange_weak(outbound, Pack(pFirstTask, UnpackTag(outbound) + 1), std::memory_order_release, std::memory_order_relaxed));
+}
+
+H1TaskDeclaration* H1IntrusiveTaskQueue::DequeueTask()
+{
+	TaggedPointer outbound = m_Outbound.load(std::memory_order_acquire);
+	while (true)
+	{
+		H1TaskDeclaration* pTask = UnpackPointer(outbound);
+		if (pTask == nullptr)
+			break;
+
+		// the link could be stale when other consumer popped it first; then the tag is changed and CAS fails
+		H1TaskDeclaration* pNextTask = pTask->GetQueueNext();
+		if (m_Outbound.compare_exchange_weak(outbound, Pack(pNextTask, UnpackTag(outbound) + 1), std::memory_order_acquire, std::memory_order_acquire))
+			return pTask;
+	}
+
+	// the outbound list is empty; take all tasks from the inbound stack
+	H1TaskDeclaration* pNewestTask = m_Inbound.exchange(nullptr, std::memory_order_acquire);
+	if (pNewestTask == nullptr)
+		return nullptr;
+
+	// reverse it to the oldest first
+	H1TaskDeclaration* pOldestTask = nullptr;
+	H1TaskDeclaration* pTask = pNewestTask;
+	while (pTask != nullptr)
+	{
+		H1TaskDeclaration* pNextTask = pTask->GetQueueNext();
+		pTask->SetQueueNext(pOldestTask);
+		pOldestTask = pTask;
+		pTask = pNextTask;
+	}
+
+	// take the oldest one; rest of them are published to other consumers
+	H1TaskDeclaration* pRestTask = pOldestTask->GetQueueNext();
+	if (pRestTask != nullptr)
+		SpliceOutbound(pRestTask, pNewestTask);
+
+	pOldestTask->SetQueueNext(nullptr);
+	return pOldestTask;
+}
+
+int32_t H1IntrusiveTaskQueue::DequeueTaskBulk(H1TaskDeclaration** ppTasks, int32_t maxTaskCounts)
+{
+	int32_t dequeuedCounts = 0;
+	while (dequeuedCounts < maxTaskCounts)
+	{
+		H1TaskDeclaration* pTask = DequeueTask();
+		if (pTask == nullptr)
+			break;
+		ppTasks[dequeuedCounts++] = pTask;
+	}
+	return dequeuedCounts;
+}
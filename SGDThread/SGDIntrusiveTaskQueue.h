@@ -0,0 +1,70 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDTask.h"
+
+namespace SGD
+{
+	// intrusive lock-free MPMC task queue
+	//	- the link lives in H1TaskDeclaration (m_QueueNext); the queue never allocates memory
+	//	- producers push pre-linked list into the inbound stack with one CAS
+	//	- the consumer finding the outbound list empty takes the whole inbound stack (exchange) and reverses it to FIFO order
+	//	- consumers pop the outbound list with tagged head (ABA-safe)
+	//	- FIFO within the batch; batches racing with refill of the outbound list could be reordered
+	//	- NOTE THAT - same as other queues, the declaration should be alive while it is queued
+	//	- NOTE THAT - the consumer could read the link of the declaration popped by other consumer (stale value is rejected by the tag)
+	class H1IntrusiveTaskQueue
+	{
+	public:
+		H1IntrusiveTaskQueue();
+		~H1IntrusiveTaskQueue();
+
+		bool EnqueueTask(H1TaskDeclaration* pTask);
+		// link the array of tasks and splice it at once
+		bool EnqueueTaskRange(H1TaskDeclaration* tasks, int32_t taskCounts);
+		// splice the list linked by SetQueueNext from the newest (head) to the oldest (tail)
+		bool EnqueueTaskList(H1TaskDeclaration* pNewestTask, H1TaskDeclaration* pOldestTask);
+
+		H1TaskDeclaration* DequeueTask();
+		int32_t DequeueTaskBulk(H1TaskDeclaration** ppTasks, int32_t maxTaskCounts);
+
+	private:
+		// tagged pointer (the tag is increased on every update of the outbound head)
+		typedef uint64_t TaggedPointer;
+		static const uint32_t PointerBits = (sizeof(void*) == 8) ? 48 : 32;
+		static inline TaggedPointer Pack(H1TaskDeclaration* pTask, uint64_t tag) { return (tag << PointerBits) | static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pTask)); }
+		static inline H1TaskDeclaration* UnpackPointer(TaggedPointer taggedPointer) { return reinterpret_cast<H1TaskDeclaration*>(static_cast<uintptr_t>(taggedPointer & ((1ull << PointerBits) - 1))); }
+		static inline uint64_t UnpackTag(TaggedPointer taggedPointer) { return taggedPointer >> PointerBits; }
+
+		// push the list (ordered from the oldest to the newest) in front of the outbound list
+		void SpliceOutbound(H1TaskDeclaration* pFirstTask, H1TaskDeclaration* pLastTask);
+
+		// producers' stack (the newest first)
+		std::atomic<H1TaskDeclaration*> m_Inbound;
+		// producers and consumers are on the different cache lines
+		char m_Padding[64];
+		// consumers' list (the oldest first)
+		std::atomic<TaggedPointer> m_Outbound;
+	};
+}
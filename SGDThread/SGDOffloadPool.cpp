@@ -0,0 +1,228 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "SGDThreadPCH.h"
+#include "SGDOffloadPool.h"
+#include "SGDTaskScheduler.h"
+using namespace SGD;
+
+H1OffloadPool::H1OffloadPool()
+	: m_MinThreadCounts(0)
+	, m_MaxThreadCounts(DefaultMaxThreadCounts)
+	, m_IdleTimeoutMilliseconds(DefaultIdleTimeoutMilliseconds)
+	, m_Head(nullptr)
+	, m_Tail(nullptr)
+	, m_ThreadCounts(0)
+	, m_IdleThreadCounts(0)
+	, m_bQuit(false)
+{
+	memset(&m_Metrics, 0, sizeof(m_Metrics));
+}
+
+H1OffloadPool::~H1OffloadPool()
+{
+
+}
+
+bool H1OffloadPool::Initialize(uint32_t minThreadCounts, uint32_t maxThreadCounts, uint32_t idleTimeoutMilliseconds)
+{
+	m_MinThreadCounts = minThreadCounts;
+	m_MaxThreadCounts = maxThreadCounts > 0 ? maxThreadCounts : 1;
+	m_IdleTimeoutMilliseconds = idleTimeoutMilliseconds;
+	m_bQuit = false;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	while (m_ThreadCounts < m_MinThreadCounts)
+		SpawnThread();
+	return true;
+}
+
+void H1OffloadPool::Destroy()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_bQuit = true;
+	m_RequestCondition.notify_all();
+
+	// the threads drain the queued requests before they exit
+	while (m_ThreadCounts > 0)
+		m_ExitCondition.wait(lock);
+
+	// join out of the lock; the exiting thread could still be releasing it
+	std::vector<std::thread> threads;
+	threads.swap(m_Threads);
+	m_ExitedThreadIds.clear();
+	lock.unlock();
+
+	for (std::thread& rThread : threads)
+		rThread.join();
+}
+
+void H1OffloadPool::Run(OffloadEntryPoint entryPoint, void* data)
+{
+	H1OffloadRequest request(entryPoint, data);
+	H1FiberWaitQueue::Suspend(&request.Waiter, ParkOnOffload, &request);
+}
+
+void H1OffloadPool::Post(H1OffloadRequest* pRequest)
+{
+	assert(pRequest->Completion != nullptr && "[invalid] the posted request needs the completion");
+	Enqueue(pRequest);
+}
+
+bool H1OffloadPool::ParkOnOffload(H1FiberContext* pFiberContext, void* pData)
+{
+	// the fiber left its stack; the offload thread could resume it right after the enqueue
+	H1OffloadRequest* pRequest = reinterpret_cast<H1OffloadRequest*>(pData);
+	H1TaskSchedulerLayer::GetTaskScheduler()->GetOffloadPool().Enqueue(pRequest);
+	return true;
+}
+
+void H1OffloadPool::Enqueue(H1OffloadRequest* pRequest)
+{
+	pRequest->EnqueueTimestamp = appGetTimestamp();
+	pRequest->Next = nullptr;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Tail == nullptr)
+		m_Head = pRequest;
+	else
+		m_Tail->Next = pRequest;
+	m_Tail = pRequest;
+
+	++m_Metrics.QueueDepth;
+	m_Metrics.MaxQueueDepth = std::max(m_Metrics.MaxQueueDepth, m_Metrics.QueueDepth);
+
+	// every thread is blocked in the calls; grow the pool
+	if (m_IdleThreadCounts < m_Metrics.QueueDepth && m_ThreadCounts < m_MaxThreadCounts)
+		SpawnThread();
+	else
+		m_RequestCondition.notify_one();
+}
+
+void H1OffloadPool::SpawnThread()
+{
+	JoinExitedThreads();
+
+	++m_ThreadCounts;
+	m_Metrics.ThreadCounts = m_ThreadCounts;
+	m_Metrics.MaxThreadCounts = std::max(m_Metrics.MaxThreadCounts, m_ThreadCounts);
+	m_Threads.emplace_back(OffloadThreadEntryPoint, this);
+}
+
+void H1OffloadPool::JoinExitedThreads()
+{
+	// the exited thread released the lock we hold; it finishes right after
+	for (std::thread::id exitedThreadId : m_ExitedThreadIds)
+	{
+		for (size_t index = 0; index < m_Threads.size(); ++index)
+		{
+			if (m_Threads[index].get_id() != exitedThreadId)
+				continue;
+			m_Threads[index].join();
+			m_Threads[index] = std::move(m_Threads.back());
+			m_Threads.pop_back();
+			break;
+		}
+	}
+	m_ExitedThreadIds.clear();
+}
+
+void H1OffloadPool::OffloadThreadEntryPoint(H1OffloadPool* pOffloadPool)
+{
+	std::unique_lock<std::mutex> lock(pOffloadPool->m_Mutex);
+	while (true)
+	{
+		H1OffloadRequest* pRequest = pOffloadPool->m_Head;
+		if (pRequest == nullptr)
+		{
+			if (pOffloadPool->m_bQuit)
+				break;
+
+			// wait for the request; the idle thread above the min exits after the timeout
+			++pOffloadPool->m_IdleThreadCounts;
+			bool bTimeout = pOffloadPool->m_RequestCondition.wait_for(lock, std::chrono::milliseconds(pOffloadPool->m_IdleTimeoutMilliseconds)) == std::cv_status::timeout;
+			--pOffloadPool->m_IdleThreadCounts;
+
+			if (bTimeout && pOffloadPool->m_Head == nullptr && pOffloadPool->m_ThreadCounts > pOffloadPool->m_MinThreadCounts)
+				break;
+			continue;
+		}
+
+		pOffloadPool->m_Head = pRequest->Next;
+		if (pOffloadPool->m_Head == nullptr)
+			pOffloadPool->m_Tail = nullptr;
+		--pOffloadPool->m_Metrics.QueueDepth;
+		lock.unlock();
+
+		// run the blocking call out of the lock
+		uint64_t startTimestamp = appGetTimestamp();
+		pRequest->EntryPoint(pRequest->Data);
+		uint64_t completeTimestamp = appGetTimestamp();
+
+		// record the call before waking; the resumed caller could read the metrics right after
+		lock.lock();
+		pOffloadPool->RecordLatency(startTimestamp - pRequest->EnqueueTimestamp, completeTimestamp - pRequest->EnqueueTimestamp);
+		lock.unlock();
+
+		// NOTE THAT - don't touch the request after waking (or the completion); the resumed fiber owns it
+		if (pRequest->Completion != nullptr)
+			pRequest->Completion(pRequest->Data);
+		else
+			H1FiberWaitQueue::Wake(&pRequest->Waiter);
+
+		lock.lock();
+	}
+
+	// the handle is joined by the next spawn (or Destroy)
+	pOffloadPool->m_ExitedThreadIds.push_back(std::this_thread::get_id());
+	--pOffloadPool->m_ThreadCounts;
+	pOffloadPool->m_Metrics.ThreadCounts = pOffloadPool->m_ThreadCounts;
+	if (pOffloadPool->m_ThreadCounts == 0)
+		pOffloadPool->m_ExitCondition.notify_all();
+}
+
+void H1OffloadPool::RecordLatency(uint64_t queueLatency, uint64_t latency)
+{
+	++m_Metrics.CompletedCounts;
+	m_Metrics.TotalQueueLatency += queueLatency;
+	m_Metrics.MaxQueueLatency = std::max(m_Metrics.MaxQueueLatency, queueLatency);
+	m_Metrics.TotalLatency += latency;
+	m_Metrics.MaxLatency = std::max(m_Metrics.MaxLatency, latency);
+}
+
+H1OffloadMetrics H1OffloadPool::GetMetrics()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Metrics;
+}
+
+void H1OffloadPool::ResetMetrics()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	// keep the current states; only the accumulated ones are cleared
+	uint32_t queueDepth = m_Metrics.QueueDepth;
+	memset(&m_Metrics, 0, sizeof(m_Metrics));
+	m_Metrics.QueueDepth = queueDepth;
+	m_Metrics.MaxQueueDepth = queueDepth;
+	m_Metrics.ThreadCounts = m_ThreadCounts;
+	m_Metrics.MaxThreadCounts = m_ThreadCounts;
+}
@@ -0,0 +1,136 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+#include "SGDFiberWaitQueue.h"
+#include <mutex>
+#include <condition_variable>
+
+namespace SGD
+{
+	typedef void (*OffloadEntryPoint)(void* pData);
+	typedef void (*OffloadCompletion)(void* pData);
+
+	// blocking call handed over to the offload thread (on the stack of the waiting fiber)
+	struct H1OffloadRequest
+	{
+		H1OffloadRequest(OffloadEntryPoint entryPoint, void* data)
+			: EntryPoint(entryPoint)
+			, Data(data)
+			, EnqueueTimestamp(0)
+			, Next(nullptr)
+			, Completion(nullptr)
+		{}
+
+		OffloadEntryPoint EntryPoint;
+		void* Data;
+		uint64_t EnqueueTimestamp;
+		H1OffloadRequest* Next;
+		// woken by the offload thread when the call completes
+		H1FiberWaiter Waiter;
+		// called with Data instead of waking the waiter (the request enqueued by Post)
+		OffloadCompletion Completion;
+	};
+
+	// latencies are in timestamp ticks (see appGetTimestampFrequency)
+	struct H1OffloadMetrics
+	{
+		// requests waiting for the offload thread
+		uint32_t QueueDepth;
+		uint32_t MaxQueueDepth;
+		uint32_t ThreadCounts;
+		uint32_t MaxThreadCounts;
+		uint64_t CompletedCounts;
+		// from the enqueue to the start of the call
+		uint64_t TotalQueueLatency;
+		uint64_t MaxQueueLatency;
+		// from the enqueue to the completion of the call
+		uint64_t TotalLatency;
+		uint64_t MaxLatency;
+	};
+
+	// elastic pool of OS threads running blocking calls (file I/O, fsync, name resolution, ...) for the fibers
+	//	- the fiber is suspended while the call runs, so the worker thread pinned to the core keeps running other tasks
+	//	- the request is enqueued in the park callback, so the offload thread never resumes the fiber still running
+	//	- a new thread is spawned when no thread is idle (up to the max), the idle thread above the min exits after the timeout
+	class H1OffloadPool
+	{
+	public:
+		static const uint32_t DefaultMaxThreadCounts = 64;
+		static const uint32_t DefaultIdleTimeoutMilliseconds = 1000;
+
+		H1OffloadPool();
+		~H1OffloadPool();
+
+		bool Initialize(uint32_t minThreadCounts = 0, uint32_t maxThreadCounts = DefaultMaxThreadCounts, uint32_t idleTimeoutMilliseconds = DefaultIdleTimeoutMilliseconds);
+		// wait for the running calls and join all threads
+		void Destroy();
+
+		// run the call in the offload thread and suspend current fiber until it completes
+		//	- the caller which is not the fiber (e.g. main thread) waits by spinning
+		void Run(OffloadEntryPoint entryPoint, void* data);
+
+		// enqueue the request without suspending; the offload thread calls its completion after the call
+		//	- the caller owns the request until the completion is called
+		void Post(H1OffloadRequest* pRequest);
+
+		// run the callable object (e.g. lambda) like Run
+		template <typename CallableType>
+		void RunCallable(CallableType& callable)
+		{
+			Run([](void* pData) { (*reinterpret_cast<CallableType*>(pData))(); }, &callable);
+		}
+
+		H1OffloadMetrics GetMetrics();
+		void ResetMetrics();
+
+	private:
+		static bool ParkOnOffload(H1FiberContext* pFiberContext, void* pData);
+		static void OffloadThreadEntryPoint(H1OffloadPool* pOffloadPool);
+
+		void Enqueue(H1OffloadRequest* pRequest);
+		// below methods require the lock
+		void SpawnThread();
+		// join the threads exited by the idle timeout
+		void JoinExitedThreads();
+		void RecordLatency(uint64_t queueLatency, uint64_t latency);
+
+		uint32_t m_MinThreadCounts;
+		uint32_t m_MaxThreadCounts;
+		uint32_t m_IdleTimeoutMilliseconds;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_RequestCondition;
+		// signaled when the last thread exits (Destroy waits for it)
+		std::condition_variable m_ExitCondition;
+		// handles of the spawned threads; the exited ones are joined by the next spawn (or Destroy)
+		std::vector<std::thread> m_Threads;
+		std::vector<std::thread::id> m_ExitedThreadIds;
+		// FIFO of the requests
+		H1OffloadRequest* m_Head;
+		H1OffloadRequest* m_Tail;
+		uint32_t m_ThreadCounts;
+		uint32_t m_IdleThreadCounts;
+		bool m_bQuit;
+		H1OffloadMetrics m_Metrics;
+	};
+}
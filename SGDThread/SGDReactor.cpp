@@ -0,0 +1,447 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "SGDThreadPCH.h"
+#include "SGDReactor.h"
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+using namespace SGD;
+
+namespace
+{
+	inline bool IsWouldBlockError() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+	inline bool IsInterruptedError() { return WSAGetLastError() == WSAEINTR; }
+	inline bool IsConnectPendingError() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+
+	bool SetNonBlocking(IOHandle handle)
+	{
+		u_long bNonBlocking = 1;
+		return ioctlsocket(handle, FIONBIO, &bNonBlocking) == 0;
+	}
+
+	sockaddr_in GetLoopbackAddress(uint16_t port)
+	{
+		sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(port);
+		return address;
+	}
+}
+
+H1Reactor::H1Reactor()
+	: m_DescriptorCounts(0)
+	, m_bPolling(false)
+	, m_bLocked(false)
+{
+
+}
+
+H1Reactor::~H1Reactor()
+{
+
+}
+
+bool H1Reactor::Initialize()
+{
+	WSADATA wsaData;
+	return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+}
+
+void H1Reactor::Destroy()
+{
+	assert(IsEmpty() && "[invalid] the descriptors are still registered to the reactor");
+	WSACleanup();
+}
+
+bool H1Reactor::Register(H1IODescriptor* pDescriptor)
+{
+	m_DescriptorCounts.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void H1Reactor::Deregister(H1IODescriptor* pDescriptor)
+{
+	LockWaitingDescriptors();
+	m_WaitingDescriptors.erase(std::remove(m_WaitingDescriptors.begin(), m_WaitingDescriptors.end(), pDescriptor), m_WaitingDescriptors.end());
+	UnlockWaitingDescriptors();
+	m_DescriptorCounts.fetch_sub(1, std::memory_order_relaxed);
+
+	// the poll in progress could still hold the descriptor; wait for it to finish
+	while (!TryLockPolling())
+		appYieldProcessor();
+	UnlockPolling();
+}
+
+void H1Reactor::LockWaitingDescriptors()
+{
+	while (m_bLocked.exchange(true, std::memory_order_acquire))
+		appYieldProcessor();
+}
+
+void H1Reactor::UnlockWaitingDescriptors()
+{
+	m_bLocked.store(false, std::memory_order_release);
+}
+
+void H1Reactor::AddWaitingDescriptor(H1IODescriptor* pDescriptor)
+{
+	// the descriptor could be in the set already (the waiter of the other direction)
+	LockWaitingDescriptors();
+	if (std::find(m_WaitingDescriptors.begin(), m_WaitingDescriptors.end(), pDescriptor) == m_WaitingDescriptors.end())
+		m_WaitingDescriptors.push_back(pDescriptor);
+	UnlockWaitingDescriptors();
+}
+
+bool H1Reactor::TryLockPolling()
+{
+	bool bExpected = false;
+	return m_bPolling.compare_exchange_strong(bExpected, true, std::memory_order_acquire);
+}
+
+void H1Reactor::UnlockPolling()
+{
+	m_bPolling.store(false, std::memory_order_release);
+}
+
+int32_t H1Reactor::Poll(uint32_t timeoutMilliseconds)
+{
+	if (IsEmpty() || !TryLockPolling())
+		return 0;
+
+	// collect the waiters and wake them after the poll is unlocked
+	H1FiberWaiter* pWakeWaiters = nullptr;
+	auto notifyReady = [&pWakeWaiters](H1IODescriptor* pDescriptor, EIODirection direction)
+	{
+		H1FiberWaiter* pWaiter = pDescriptor->NotifyReady(direction);
+		if (pWaiter != nullptr)
+		{
+			pWaiter->Next = pWakeWaiters;
+			pWakeWaiters = pWaiter;
+		}
+	};
+
+	// poll only the directions with the parked waiter (WSAPoll is level-triggered)
+	m_PollDescriptors.clear();
+	m_PollHandles.clear();
+	LockWaitingDescriptors();
+	for (H1IODescriptor* pDescriptor : m_WaitingDescriptors)
+	{
+		SHORT events = 0;
+		if (pDescriptor->HasWaiter(EIOD_Read))
+			events |= POLLRDNORM;
+		if (pDescriptor->HasWaiter(EIOD_Write))
+			events |= POLLWRNORM;
+		if (events == 0)
+			continue;
+
+		WSAPOLLFD pollHandle;
+		pollHandle.fd = pDescriptor->GetHandle();
+		pollHandle.events = events;
+		pollHandle.revents = 0;
+		m_PollHandles.push_back(pollHandle);
+		m_PollDescriptors.push_back(pDescriptor);
+	}
+	UnlockWaitingDescriptors();
+
+	// the descriptor with the parked waiter is never destroyed until this poll wakes it (Deregister waits for the poll)
+	if (!m_PollHandles.empty() && WSAPoll(m_PollHandles.data(), ULONG(m_PollHandles.size()), INT(timeoutMilliseconds)) > 0)
+	{
+		for (size_t i = 0; i < m_PollHandles.size(); ++i)
+		{
+			SHORT revents = m_PollHandles[i].revents;
+			if (revents & (POLLRDNORM | POLLHUP | POLLERR | POLLNVAL))
+				notifyReady(m_PollDescriptors[i], EIOD_Read);
+			if (revents & (POLLWRNORM | POLLHUP | POLLERR | POLLNVAL))
+				notifyReady(m_PollDescriptors[i], EIOD_Write);
+		}
+	}
+
+	// drop the descriptors without the waiter from the set
+	//	- the waiter parking after here adds its descriptor again (it publishes the waiter before taking the lock)
+	LockWaitingDescriptors();
+	m_WaitingDescriptors.erase(std::remove_if(m_WaitingDescriptors.begin(), m_WaitingDescriptors.end(),
+		[](H1IODescriptor* pDescriptor) { return !pDescriptor->HasWaiter(EIOD_Read) && !pDescriptor->HasWaiter(EIOD_Write); }),
+		m_WaitingDescriptors.end());
+	UnlockWaitingDescriptors();
+
+	UnlockPolling();
+
+	int32_t wokenCounts = 0;
+	while (pWakeWaiters != nullptr)
+	{
+		H1FiberWaiter* pNextWaiter = pWakeWaiters->Next;
+		H1FiberWaitQueue::Wake(pWakeWaiters);
+		pWakeWaiters = pNextWaiter;
+		++wokenCounts;
+	}
+	return wokenCounts;
+}
+
+H1IODescriptor::H1IODescriptor()
+	: m_Handle(InvalidIOHandle)
+	, m_Reactor(nullptr)
+{
+	m_States[EIOD_Read].store(StateNone, std::memory_order_relaxed);
+	m_States[EIOD_Write].store(StateNone, std::memory_order_relaxed);
+}
+
+H1IODescriptor::~H1IODescriptor()
+{
+
+}
+
+bool H1IODescriptor::Initialize(IOHandle handle, H1Reactor* pReactor)
+{
+	m_Handle = handle;
+	m_Reactor = pReactor;
+	if (m_Reactor == nullptr)
+		return true; // blocking descriptor
+
+	if (!SetNonBlocking(m_Handle) || !m_Reactor->Register(this))
+	{
+		m_Reactor = nullptr;
+		return false;
+	}
+	return true;
+}
+
+void H1IODescriptor::Destroy()
+{
+	if (m_Reactor != nullptr)
+	{
+		m_Reactor->Deregister(this);
+		m_Reactor = nullptr;
+	}
+
+	if (m_Handle != InvalidIOHandle)
+	{
+		CloseIOHandle(m_Handle);
+		m_Handle = InvalidIOHandle;
+	}
+}
+
+int64_t H1IODescriptor::Read(void* buffer, size_t size)
+{
+	while (true)
+	{
+		int64_t readBytes = ::recv(m_Handle, reinterpret_cast<char*>(buffer), int(size), 0);
+		if (readBytes >= 0)
+			return readBytes;
+		if (IsInterruptedError())
+			continue;
+		if (m_Reactor == nullptr || !IsWouldBlockError())
+			return -1;
+
+		WaitReady(EIOD_Read);
+	}
+}
+
+bool H1IODescriptor::ReadExactly(void* buffer, size_t size)
+{
+	uint8_t* pBytes = reinterpret_cast<uint8_t*>(buffer);
+	size_t readBytes = 0;
+	while (readBytes < size)
+	{
+		int64_t bytes = Read(pBytes + readBytes, size - readBytes);
+		if (bytes <= 0)
+			return false;
+		readBytes += size_t(bytes);
+	}
+	return true;
+}
+
+int64_t H1IODescriptor::Write(const void* buffer, size_t size)
+{
+	const char* pBytes = reinterpret_cast<const char*>(buffer);
+	size_t writtenBytes = 0;
+	while (writtenBytes < size)
+	{
+		int64_t bytes = ::send(m_Handle, pBytes + writtenBytes, int(size - writtenBytes), 0);
+		if (bytes >= 0)
+		{
+			writtenBytes += size_t(bytes);
+			continue;
+		}
+		if (IsInterruptedError())
+			continue;
+		if (m_Reactor == nullptr || !IsWouldBlockError())
+			return -1;
+
+		WaitReady(EIOD_Write);
+	}
+	return int64_t(writtenBytes);
+}
+
+IOHandle H1IODescriptor::Accept()
+{
+	while (true)
+	{
+		IOHandle handle = ::accept(m_Handle, nullptr, nullptr);
+		if (handle != InvalidIOHandle)
+		{
+			// no delay for the request-response traffic
+			int bNoDelay = 1;
+			setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&bNoDelay), sizeof(bNoDelay));
+			return handle;
+		}
+		if (IsInterruptedError())
+			continue;
+		if (m_Reactor == nullptr || !IsWouldBlockError())
+			return InvalidIOHandle;
+
+		WaitReady(EIOD_Read);
+	}
+}
+
+bool H1IODescriptor::ConnectLoopback(uint16_t port)
+{
+	sockaddr_in address = GetLoopbackAddress(port);
+	if (::connect(m_Handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+		return true;
+	if (m_Reactor == nullptr || !IsConnectPendingError())
+		return false;
+
+	// the connection completes when the socket becomes writable
+	WaitReady(EIOD_Write);
+	int error = 0;
+	socklen_t errorSize = sizeof(error);
+	if (getsockopt(m_Handle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &errorSize) != 0)
+		return false;
+	return error == 0;
+}
+
+void H1IODescriptor::WaitReady(EIODirection direction)
+{
+	// the event came after the last try; consume it and retry
+	intptr_t expected = StateReady;
+	if (m_States[direction].compare_exchange_strong(expected, StateNone))
+		return;
+
+	H1FiberWaiter waiter;
+	ParkData parkData = { this, direction, &waiter };
+	H1FiberWaitQueue::Suspend(&waiter, ParkOnDescriptor, &parkData);
+}
+
+bool H1IODescriptor::ParkOnDescriptor(H1FiberContext* pFiberContext, void* pData)
+{
+	ParkData* pParkData = reinterpret_cast<ParkData*>(pData);
+	std::atomic<intptr_t>& rState = pParkData->Descriptor->m_States[pParkData->Direction];
+
+	intptr_t expected = StateNone;
+	if (rState.compare_exchange_strong(expected, reinterpret_cast<intptr_t>(pParkData->Waiter)))
+	{
+		// only the poller wakes the waiter, and it polls only the waiter set; the descriptor is alive until then
+		pParkData->Descriptor->m_Reactor->AddWaitingDescriptor(pParkData->Descriptor);
+		return true;
+	}
+
+	// the event came while parking; consume it and resume immediately
+	assert(expected == StateReady && "[invalid] another fiber already waits for the descriptor in the same direction");
+	rState.store(StateNone, std::memory_order_release);
+	return false;
+}
+
+H1FiberWaiter* H1IODescriptor::NotifyReady(EIODirection direction)
+{
+	std::atomic<intptr_t>& rState = m_States[direction];
+	intptr_t state = rState.load(std::memory_order_acquire);
+	while (true)
+	{
+		if (state == StateReady)
+			return nullptr;
+
+		// keep the event for the next wait, or hand it over to the parked waiter
+		intptr_t newState = StateNone;
+		if (state == StateNone)
+			newState = StateReady;
+		if (rState.compare_exchange_weak(state, newState))
+			return state == StateNone ? nullptr : reinterpret_cast<H1FiberWaiter*>(state);
+	}
+}
+
+IOHandle H1IODescriptor::CreateSocket()
+{
+	IOHandle handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (handle == InvalidIOHandle)
+		return InvalidIOHandle;
+
+	int bNoDelay = 1;
+	setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&bNoDelay), sizeof(bNoDelay));
+	return handle;
+}
+
+IOHandle H1IODescriptor::CreateLoopbackListener(uint16_t& port)
+{
+	IOHandle handle = CreateSocket();
+	if (handle == InvalidIOHandle)
+		return InvalidIOHandle;
+
+	sockaddr_in address = GetLoopbackAddress(port);
+	socklen_t addressSize = sizeof(address);
+	if (::bind(handle, reinterpret_cast<const sockaddr*>(&address), addressSize) != 0
+		|| ::listen(handle, SOMAXCONN) != 0
+		|| ::getsockname(handle, reinterpret_cast<sockaddr*>(&address), &addressSize) != 0)
+	{
+		CloseIOHandle(handle);
+		return InvalidIOHandle;
+	}
+
+	port = ntohs(address.sin_port);
+	return handle;
+}
+
+bool H1IODescriptor::CreatePipe(IOHandle& readHandle, IOHandle& writeHandle)
+{
+	// WSAPoll doesn't poll the anonymous pipe; connect the loopback socket pair instead
+	readHandle = InvalidIOHandle;
+	writeHandle = InvalidIOHandle;
+	uint16_t port = 0;
+	IOHandle listenHandle = CreateLoopbackListener(port);
+	if (listenHandle == InvalidIOHandle)
+		return false;
+
+	writeHandle = CreateSocket();
+	sockaddr_in address = GetLoopbackAddress(port);
+	if (writeHandle != InvalidIOHandle && ::connect(writeHandle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+		readHandle = ::accept(listenHandle, nullptr, nullptr);
+	CloseIOHandle(listenHandle);
+
+	if (readHandle == InvalidIOHandle)
+	{
+		if (writeHandle != InvalidIOHandle)
+			CloseIOHandle(writeHandle);
+		writeHandle = InvalidIOHandle;
+		return false;
+	}
+
+	// one-way like the pipe
+	::shutdown(readHandle, SD_SEND);
+	::shutdown(writeHandle, SD_RECEIVE);
+	return true;
+}
+
+void H1IODescriptor::CloseIOHandle(IOHandle handle)
+{
+	::closesocket(handle);
+}
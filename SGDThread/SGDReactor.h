@@ -0,0 +1,148 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+#include "SGDFiberWaitQueue.h"
+
+namespace SGD
+{
+	// native handle of the socket (or the pipe)
+	typedef uintptr_t IOHandle;
+	const IOHandle InvalidIOHandle = IOHandle(-1);
+
+	enum EIODirection
+	{
+		EIOD_Read,
+		EIOD_Write,
+		EIOD_Max,
+	};
+
+	// forward declaration
+	class H1IODescriptor;
+
+	// I/O readiness reactor resuming the fibers parked on the descriptors
+	//	- WSAPoll over the waiter set (the descriptors with the parked waiter), not over all registered ones;
+	//	  the parked fiber adds its descriptor to the set and the poller drops the descriptor whose waiters are woken
+	//	- the idle worker thread polls it with zero timeout between the queue checks (see WorkerThreadEntryPoint)
+	//	- only one thread polls at once; the others skip polling instead of waiting
+	class H1Reactor
+	{
+	public:
+		static const int32_t MaxPollEventCounts = 64;
+
+		H1Reactor();
+		~H1Reactor();
+
+		bool Initialize();
+		void Destroy();
+
+		bool Register(H1IODescriptor* pDescriptor);
+		// after it returns, the poller never touches the descriptor
+		void Deregister(H1IODescriptor* pDescriptor);
+
+		// resume the fibers waiting for the ready descriptors; return the number of the woken fibers
+		int32_t Poll(uint32_t timeoutMilliseconds = 0);
+
+		// hint for skipping the poll; it could be stale
+		inline bool IsEmpty() const { return m_DescriptorCounts.load(std::memory_order_relaxed) == 0; }
+
+		// called after the waiter is published to the descriptor
+		void AddWaitingDescriptor(H1IODescriptor* pDescriptor);
+
+	private:
+		bool TryLockPolling();
+		void UnlockPolling();
+
+		std::atomic<int32_t> m_DescriptorCounts;
+		std::atomic<bool> m_bPolling;
+		void LockWaitingDescriptors();
+		void UnlockWaitingDescriptors();
+
+		// waiter set protected by the spin-lock (Register/Deregister don't walk it)
+		std::atomic<bool> m_bLocked;
+		std::vector<H1IODescriptor*> m_WaitingDescriptors;
+		// scratch of the poller (protected by m_bPolling)
+		std::vector<H1IODescriptor*> m_PollDescriptors;
+		std::vector<WSAPOLLFD> m_PollHandles;
+	};
+
+	// non-blocking socket (or pipe) parking the fiber until it is ready instead of blocking the worker thread
+	//	- the readiness of each direction is a state: none, ready (the event came while nobody waited) or the parked waiter
+	//	- Read/Write try the I/O first and park only when it would block; the ready event resumes the fiber to retry
+	//	- the descriptor without the reactor keeps the handle blocking (e.g. thread-per-connection)
+	//	- one waiter per direction at once (e.g. one reader fiber and one writer fiber)
+	//	- the pipe is the connected loopback socket pair (WSAPoll polls only the sockets)
+	class H1IODescriptor
+	{
+	public:
+		H1IODescriptor();
+		~H1IODescriptor();
+
+		// take the ownership of the handle; it is switched to non-blocking and registered when the reactor is given
+		bool Initialize(IOHandle handle, H1Reactor* pReactor);
+		// deregister and close the handle
+		void Destroy();
+
+		// return the read bytes (0 at the end of the stream, -1 on error)
+		int64_t Read(void* buffer, size_t size);
+		// read until the buffer is filled; false at the end of the stream (or on error) before it is filled
+		bool ReadExactly(void* buffer, size_t size);
+		// write all bytes; return the written bytes (-1 on error)
+		int64_t Write(const void* buffer, size_t size);
+		// return the accepted handle (InvalidIOHandle on error)
+		IOHandle Accept();
+		bool ConnectLoopback(uint16_t port);
+
+		inline IOHandle GetHandle() const { return m_Handle; }
+		inline bool HasWaiter(EIODirection direction) const { intptr_t state = m_States[direction].load(std::memory_order_acquire); return state != StateNone && state != StateReady; }
+
+		// called by the reactor; return the waiter to wake (or null)
+		H1FiberWaiter* NotifyReady(EIODirection direction);
+
+		// handle utilities
+		static IOHandle CreateSocket();
+		// listening socket bound to the loopback address; the port is chosen by the system when it is zero
+		static IOHandle CreateLoopbackListener(uint16_t& port);
+		static bool CreatePipe(IOHandle& readHandle, IOHandle& writeHandle);
+		static void CloseIOHandle(IOHandle handle);
+
+	private:
+		static const intptr_t StateNone = 0;
+		static const intptr_t StateReady = 1;
+
+		struct ParkData
+		{
+			H1IODescriptor* Descriptor;
+			EIODirection Direction;
+			H1FiberWaiter* Waiter;
+		};
+
+		// consume the ready state, or park current fiber until the descriptor is ready
+		void WaitReady(EIODirection direction);
+		static bool ParkOnDescriptor(H1FiberContext* pFiberContext, void* pData);
+
+		IOHandle m_Handle;
+		H1Reactor* m_Reactor;
+		// StateNone, StateReady or H1FiberWaiter*
+		std::atomic<intptr_t> m_States[EIOD_Max];
+	};
+}
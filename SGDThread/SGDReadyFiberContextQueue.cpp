@@ -0,0 +1,103 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDReadyFiberContextQueue.h"
+using namespace SGD;
+
+H1ReadyFiberContextQueue::H1ReadyFiberContextQueue()
+	: m_Head(&m_Stub)
+	, m_Tail(&m_Stub)
+	, m_bConsuming(false)
+{
+
+}
+
+H1ReadyFiberContextQueue::~H1ReadyFiberContextQueue()
+{
+
+}
+
+void H1ReadyFiberContextQueue::Enqueue(H1FiberContext* pFiberContext)
+{
+	Push(pFiberContext->GetReadyLink());
+}
+
+void H1ReadyFiberContextQueue::Push(H1ReadyFiberContextLink* pLink)
+{
+	pLink->Next.store(nullptr, std::memory_order_relaxed);
+	// swing the head first, then link the previous head to the new one (the consumer waits for the link if it sees the gap)
+	H1ReadyFiberContextLink* pPrevLink = m_Head.exchange(pLink, std::memory_order_acq_rel);
+	pPrevLink->Next.store(pLink, std::memory_order_release);
+}
+
+H1FiberContext* H1ReadyFiberContextQueue::Dequeue()
+{
+	if (IsEmpty())
+		return nullptr;
+
+	// only one consumer at once (usually the owner worker thread, so it is not contended)
+	if (m_bConsuming.exchange(true, std::memory_order_acquire))
+		return nullptr;
+
+	H1ReadyFiberContextLink* pLink = Pop();
+	m_bConsuming.store(false, std::memory_order_release);
+
+	return pLink != nullptr ? pLink->FiberContext : nullptr;
+}
+
+H1ReadyFiberContextLink* H1ReadyFiberContextQueue::Pop()
+{
+	H1ReadyFiberContextLink* pTail = m_Tail;
+	H1ReadyFiberContextLink* pNext = pTail->Next.load(std::memory_order_acquire);
+
+	// skip the stub link
+	if (pTail == &m_Stub)
+	{
+		if (pNext == nullptr)
+			return nullptr;
+		m_Tail = pNext;
+		pTail = pNext;
+		pNext = pNext->Next.load(std::memory_order_acquire);
+	}
+
+	if (pNext != nullptr)
+	{
+		m_Tail = pNext;
+		return pTail;
+	}
+
+	// the producer is linking a new node after the tail
+	if (pTail != m_Head.load(std::memory_order_acquire))
+		return nullptr;
+
+	// the tail is the last one; push the stub back to detach the tail
+	Push(&m_Stub);
+	pNext = pTail->Next.load(std::memory_order_acquire);
+	if (pNext != nullptr)
+	{
+		m_Tail = pNext;
+		return pTail;
+	}
+	return nullptr;
+}
@@ -0,0 +1,62 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDFiberContext.h"
+
+namespace SGD
+{
+	// intrusive wait-free MPSC queue of the fiber contexts ready to resume (one per worker thread)
+	//	- the link lives in H1FiberContext (H1ReadyFiberContextLink); the queue never allocates memory
+	//	- making the fiber ready is one atomic exchange for the producer (e.g. H1TaskCounter reaching zero)
+	//	- the owner worker thread pops it; idle worker threads could steal it (consumers are serialized by try-lock)
+	//	- Dequeue could fail spuriously while the producer is between the exchange and linking the node; retry it later
+	//	- NOTE THAT - the fiber context must not be enqueued twice before it is dequeued
+	class H1ReadyFiberContextQueue
+	{
+	public:
+		H1ReadyFiberContextQueue();
+		~H1ReadyFiberContextQueue();
+
+		void Enqueue(H1FiberContext* pFiberContext);
+		// return null when it is empty (or another consumer is dequeueing)
+		H1FiberContext* Dequeue();
+
+		// hint for the thieves; it could be stale
+		inline bool IsEmpty() const { return m_Head.load(std::memory_order_relaxed) == &m_Stub; }
+
+	private:
+		void Push(H1ReadyFiberContextLink* pLink);
+		H1ReadyFiberContextLink* Pop();
+
+		// producers' side (the newest link)
+		std::atomic<H1ReadyFiberContextLink*> m_Head;
+		char m_Padding0[64];
+		// consumer's side (the oldest link)
+		H1ReadyFiberContextLink* m_Tail;
+		std::atomic<bool> m_bConsuming;
+		char m_Padding1[64];
+		// stub link keeping the queue non-empty
+		H1ReadyFiberContextLink m_Stub;
+	};
+}
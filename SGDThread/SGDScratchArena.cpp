@@ -0,0 +1,75 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDScratchArena.h"
+using namespace SGD;
+
+H1ScratchArena::H1ScratchArena()
+	: m_Memory(nullptr)
+	, m_Capacity(0)
+	, m_Offset(0)
+{
+
+}
+
+H1ScratchArena::~H1ScratchArena()
+{
+	Destroy();
+}
+
+bool H1ScratchArena::Initialize(size_t capacity)
+{
+	// page-aligned memory from OS (not shared with process heap)
+	m_Memory = reinterpret_cast<char*>(appAllocateVirtualMemory(capacity));
+	if (m_Memory == nullptr)
+		return false;
+
+	m_Capacity = capacity;
+	m_Offset = 0;
+	return true;
+}
+
+void H1ScratchArena::Destroy()
+{
+	if (m_Memory == nullptr)
+		return;
+
+	appFreeVirtualMemory(m_Memory);
+	m_Memory = nullptr;
+	m_Capacity = 0;
+	m_Offset = 0;
+}
+
+void* H1ScratchArena::Allocate(size_t size, size_t alignment)
+{
+	size_t alignedOffset = (m_Offset + (alignment - 1)) & ~(alignment - 1);
+	if (alignedOffset + size > m_Capacity)
+	{
+		assert(false && "[invalid] the scratch arena runs out of memory");
+		return nullptr;
+	}
+
+	m_Offset = alignedOffset + size;
+	return m_Memory + alignedOffset;
+}
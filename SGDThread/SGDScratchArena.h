@@ -0,0 +1,87 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+namespace SGD
+{
+	// linear allocator for temporaries whose lifetime is the task-body
+	//	- attached to the fiber context lazily (see H1FiberContext::GetScratchArena) and reset when the fiber returns to the pool
+	//	- Push() returns the marker and Pop(marker) frees all allocations after the marker at once
+	//	- the memory is kept across the tasks, so allocation is free after the first use
+	class H1ScratchArena
+	{
+	public:
+		typedef size_t Marker;
+		// default capacity for the fiber context (bigger than small fiber stack)
+		static const size_t DefaultCapacity = 256 * 1024;
+
+		H1ScratchArena();
+		~H1ScratchArena();
+
+		bool Initialize(size_t capacity = DefaultCapacity);
+		void Destroy();
+
+		// return null when the arena runs out of memory
+		void* Allocate(size_t size, size_t alignment = 16);
+		template <class Type>
+		Type* AllocateArray(size_t counts)
+		{
+			return reinterpret_cast<Type*>(Allocate(sizeof(Type) * counts, alignof(Type)));
+		}
+
+		inline Marker Push() const { return m_Offset; }
+		inline void Pop(Marker marker) { assert(marker <= m_Offset && "[invalid] the marker is already popped"); m_Offset = marker; }
+		inline void Reset() { m_Offset = 0; }
+
+		inline size_t GetCapacity() const { return m_Capacity; }
+		inline size_t GetUsedSize() const { return m_Offset; }
+
+	private:
+		char* m_Memory;
+		size_t m_Capacity;
+		size_t m_Offset;
+	};
+
+	// pop the scratch arena to the marker at the end of the scope
+	class H1ScratchScope
+	{
+	public:
+		explicit H1ScratchScope(H1ScratchArena& arena)
+			: m_Arena(arena)
+			, m_Marker(arena.Push())
+		{}
+
+		~H1ScratchScope()
+		{
+			m_Arena.Pop(m_Marker);
+		}
+
+	private:
+		H1ScratchScope(const H1ScratchScope&) = delete;
+		H1ScratchScope& operator=(const H1ScratchScope&) = delete;
+
+		H1ScratchArena& m_Arena;
+		H1ScratchArena::Marker m_Marker;
+	};
+}
@@ -0,0 +1,174 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDTaggedHeap.h"
+#include "SGDWorkerThread.h"
+using namespace SGD;
+
+H1TaggedHeap::H1TaggedHeap()
+	: m_AllocatorStates(nullptr)
+	, m_WorkerThreadCounts(0)
+	, m_BlockCounts(0)
+{
+	for (uint32_t i = 0; i < MaxTagSlots; ++i)
+	{
+		m_TagSlots[i].Tag = InvalidTag;
+		m_TagSlots[i].Generation = 0;
+		m_TagSlots[i].Blocks = nullptr;
+	}
+}
+
+H1TaggedHeap::~H1TaggedHeap()
+{
+	Destroy();
+}
+
+bool H1TaggedHeap::Initialize(uint32_t workerThreadCounts)
+{
+	m_WorkerThreadCounts = workerThreadCounts;
+	m_AllocatorStates = new H1AllocatorState[workerThreadCounts + 1];
+	for (uint32_t i = 0; i <= workerThreadCounts; ++i)
+	{
+		for (uint32_t slot = 0; slot < MaxTagSlots; ++slot)
+			m_AllocatorStates[i].Cursors[slot] = { 0, nullptr, nullptr };
+	}
+
+	return true;
+}
+
+void H1TaggedHeap::Destroy()
+{
+	if (m_AllocatorStates == nullptr)
+		return;
+
+	// return blocks of all tags in flight to free block queue
+	for (uint32_t i = 0; i < MaxTagSlots; ++i)
+	{
+		H1MemoryTag tag = m_TagSlots[i].Tag.load();
+		if (tag != InvalidTag)
+			Release(tag);
+	}
+
+	// now all blocks are in free block queue
+	H1TaggedHeapBlock* pBlock = nullptr;
+	while (m_FreeBlocks.try_dequeue(pBlock))
+	{
+		appFreeVirtualMemory(pBlock);
+		m_BlockCounts--;
+	}
+
+	delete[] m_AllocatorStates;
+	m_AllocatorStates = nullptr;
+}
+
+H1TaggedHeap::H1TaggedHeapBlock* H1TaggedHeap::AcquireBlock()
+{
+	H1TaggedHeapBlock* pBlock = nullptr;
+	if (m_FreeBlocks.try_dequeue(pBlock))
+		return pBlock;
+
+	// no free block; allocate new one from OS
+	pBlock = reinterpret_cast<H1TaggedHeapBlock*>(appAllocateVirtualMemory(BlockSize));
+	if (pBlock != nullptr)
+		m_BlockCounts++;
+	return pBlock;
+}
+
+void* H1TaggedHeap::Allocate(H1MemoryTag tag, size_t size, size_t alignment)
+{
+	// the cursor is aligned by masking
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "[invalid] the alignment should be the power of two");
+	if (size + alignment > BlockSize - BlockHeaderSize)
+		return nullptr; // too big allocation for the block
+
+	// claim the slot for the tag
+	uint32_t slotIndex = static_cast<uint32_t>(tag % MaxTagSlots);
+	H1TagSlot& rTagSlot = m_TagSlots[slotIndex];
+	H1MemoryTag slotTag = rTagSlot.Tag.load(std::memory_order_acquire);
+	if (slotTag != tag)
+	{
+		slotTag = InvalidTag;
+		if (!rTagSlot.Tag.compare_exchange_strong(slotTag, tag) && slotTag != tag)
+		{
+			assert(false && "[invalid] the slot is occupied by other tag (too many tags in flight)");
+			return nullptr;
+		}
+	}
+
+	// bump cursor of current worker thread
+	H1WorkerThread* pWorkerThread = H1WorkerThread::GetCurrentWorkerThread();
+	uint32_t stateIndex = pWorkerThread != nullptr ? pWorkerThread->GetWorkerThreadIndex() : m_WorkerThreadCounts;
+	H1BumpCursor& rCursor = m_AllocatorStates[stateIndex].Cursors[slotIndex];
+
+	// the blocks of the cursor were released with the previous tag
+	uint32_t generation = rTagSlot.Generation.load(std::memory_order_acquire);
+	if (rCursor.Generation != generation)
+	{
+		rCursor.Generation = generation;
+		rCursor.Cursor = nullptr;
+		rCursor.End = nullptr;
+	}
+
+	uintptr_t address = (reinterpret_cast<uintptr_t>(rCursor.Cursor) + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+	if (rCursor.Cursor == nullptr || address + size > reinterpret_cast<uintptr_t>(rCursor.End))
+	{
+		// the block is exhausted; link new block to the tag
+		H1TaggedHeapBlock* pBlock = AcquireBlock();
+		if (pBlock == nullptr)
+			return nullptr;
+
+		H1TaggedHeapBlock* pHead = rTagSlot.Blocks.load(std::memory_order_relaxed);
+		do
+		{
+			pBlock->Next = pHead;
+		} while (!rTagSlot.Blocks.compare_exchange_weak(pHead, pBlock, std::memory_order_release, std::memory_order_relaxed));
+
+		rCursor.Cursor = reinterpret_cast<char*>(pBlock) + BlockHeaderSize;
+		rCursor.End = reinterpret_cast<char*>(pBlock) + BlockSize;
+		address = (reinterpret_cast<uintptr_t>(rCursor.Cursor) + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+	}
+
+	rCursor.Cursor = reinterpret_cast<char*>(address + size);
+	return reinterpret_cast<void*>(address);
+}
+
+void H1TaggedHeap::Release(H1MemoryTag tag)
+{
+	H1TagSlot& rTagSlot = m_TagSlots[tag % MaxTagSlots];
+	if (rTagSlot.Tag.load(std::memory_order_acquire) != tag)
+		return;
+
+	// invalidate cursors of all worker threads before the slot is reused
+	rTagSlot.Generation.fetch_add(1, std::memory_order_release);
+
+	H1TaggedHeapBlock* pBlock = rTagSlot.Blocks.exchange(nullptr, std::memory_order_acquire);
+	while (pBlock != nullptr)
+	{
+		H1TaggedHeapBlock* pNextBlock = pBlock->Next;
+		m_FreeBlocks.enqueue(pBlock);
+		pBlock = pNextBlock;
+	}
+
+	rTagSlot.Tag.store(InvalidTag, std::memory_order_release);
+}
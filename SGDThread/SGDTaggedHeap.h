@@ -0,0 +1,108 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+namespace SGD
+{
+	// tag associated with allocation (e.g. frame index, or phase of the frame)
+	typedef uint64_t H1MemoryTag;
+
+	// tagged block allocator for transient memory
+	//	- each worker thread bump-allocates from its own 2MB block for the tag (no lock, no contention on process heap)
+	//	- Release(tag) returns all blocks of the tag at once (no individual free)
+	//	- released blocks are recycled through lock-free free block queue
+	//	- tags are mapped to the slot by (tag % MaxTagSlots), so consecutive frame indices could be in flight together
+	//	- NOTE THAT - the thread which is not the worker thread (e.g. main thread) shares one allocator state; only one such thread could allocate
+	class H1TaggedHeap
+	{
+	public:
+		static const size_t BlockSize = 2 * 1024 * 1024;
+		static const uint32_t MaxTagSlots = 16;
+		static const H1MemoryTag InvalidTag = ~0ull;
+
+		H1TaggedHeap();
+		~H1TaggedHeap();
+
+		bool Initialize(uint32_t workerThreadCounts);
+		void Destroy();
+
+		// return null when the size exceeds the block or too many tags are in flight
+		//	- the alignment should be the power of two
+		void* Allocate(H1MemoryTag tag, size_t size, size_t alignment = 16);
+		// uninitialized storage for the array
+		template <class Type>
+		Type* AllocateArray(H1MemoryTag tag, size_t counts)
+		{
+			return reinterpret_cast<Type*>(Allocate(tag, sizeof(Type) * counts, alignof(Type)));
+		}
+
+		// free all allocations of the tag at once
+		//	- NOTE THAT - it should not race with Allocate of the same tag (e.g. release the frame's tag after the frame retires)
+		void Release(H1MemoryTag tag);
+
+		// blocks allocated from OS (including free blocks)
+		inline int32_t GetBlockCounts() const { return m_BlockCounts.load(std::memory_order_relaxed); }
+
+	private:
+		// header in front of each block
+		struct H1TaggedHeapBlock
+		{
+			H1TaggedHeapBlock* Next;
+		};
+		static const size_t BlockHeaderSize = 64;
+
+		struct H1TagSlot
+		{
+			std::atomic<H1MemoryTag> Tag;
+			// increased by Release(), invalidating cursors of the worker threads
+			std::atomic<uint32_t> Generation;
+			// lock-free list of blocks owned by the tag
+			std::atomic<H1TaggedHeapBlock*> Blocks;
+		};
+
+		struct H1BumpCursor
+		{
+			uint32_t Generation;
+			char* Cursor;
+			char* End;
+		};
+
+		// allocator state of one worker thread (padded to avoid false sharing with neighbor states)
+		struct H1AllocatorState
+		{
+			H1BumpCursor Cursors[MaxTagSlots];
+			char Padding[64];
+		};
+
+		H1TaggedHeapBlock* AcquireBlock();
+
+		// recycled blocks
+		moodycamel::ConcurrentQueue<H1TaggedHeapBlock*> m_FreeBlocks;
+		H1TagSlot m_TagSlots[MaxTagSlots];
+		// worker thread counts + 1 (the thread which is not the worker thread)
+		H1AllocatorState* m_AllocatorStates;
+		uint32_t m_WorkerThreadCounts;
+		std::atomic<int32_t> m_BlockCounts;
+	};
+}
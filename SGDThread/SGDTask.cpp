@@ -33,10 +33,34 @@ H1TaskDeclaration::H1TaskDeclaration(TaskEntryPoint taskBody, void* taskData)
 	, m_TaskCounter(nullptr)
 	, m_Parent(nullptr)
 	, m_Owner(nullptr)
+	, m_Next(nullptr)
+	, m_CancellationToken(nullptr)
+	, m_InheritedCancellationToken(nullptr)
+	, m_bRunWhenCancelled(false)
+	, m_Deadline(0)
+	, m_bPooled(false)
+	, m_QueuePriority(0)
+	, m_QueueNext(nullptr)
 {
 
 }
 
+void H1TaskDeclaration::Reset(TaskEntryPoint taskBody, void* taskData)
+{
+	m_TaskBody = taskBody;
+	m_TaskData = taskData;
+	m_TaskCounter = nullptr;
+	m_Parent = nullptr;
+	m_Owner = nullptr;
+	m_Next = nullptr;
+	m_CancellationToken = nullptr;
+	m_InheritedCancellationToken = nullptr;
+	m_bRunWhenCancelled = false;
+	m_Deadline = 0;
+	m_QueuePriority = 0;
+	m_QueueNext = nullptr;
+}
+
 void H1TaskDeclaration::SetTaskCounter(H1TaskCounter* counter)
 {
 	m_TaskCounter = counter;
@@ -55,55 +79,266 @@ void H1TaskDeclaration::SetTaskEntryPoint(TaskEntryPoint taskBody)
 void H1TaskDeclaration::SetParent(H1TaskDeclaration* parent)
 {
 	m_Parent = parent;
+	// cancellation propagates down to the parent chain
+	m_InheritedCancellationToken = parent != nullptr ? parent->GetCancellationToken() : nullptr;
+}
+
+void H1TaskDeclaration::SetCancellationToken(H1TaskCancellationToken* token)
+{
+	m_CancellationToken = token;
 }
 
 void H1TaskDeclaration::RunTask()
 {
+	// don't touch the declaration after the task-body; it could be enqueued again while the body returns (e.g. coroutine resume task)
+	H1TaskCounter* pTaskCounter = m_TaskCounter;
+	uint64_t deadline = m_Deadline;
+	bool bPooled = m_bPooled;
+
 	m_TaskBody(m_TaskData);
 
+	// record deadline miss before the task counter is released (the waiter could advance the frame right after)
+	if (deadline != 0)
+		H1TaskSchedulerLayer::GetTaskScheduler()->GetDeadlineMetrics().RecordCompletion(deadline, appGetTimestamp());
+
+	// pooled declaration is owned by nobody else; recycle it to the pool of current worker thread
+	if (bPooled)
+		H1TaskSchedulerLayer::GetTaskScheduler()->GetTaskDeclarationPool().Release(this);
+
+	// nobody waits for this task
+	if (pTaskCounter == nullptr)
+		return;
+
 	// @TODO - need to think about this portion of codes is appropriate to place here
-	// when it finishes task, decrement assigned task counter (parent's fiber context counter)
-	H1TaskCounter::TaskCounterType remainCounter = m_TaskCounter->Decrement();
-	// @TODO - only handling when remain counter is zero (no destined value right now)
-	if (remainCounter == 0)
+	// when it finishes task, decrement assigned task counter
+	//	- the last task enqueues continuations and resumes the fiber waiting for the counter
+	pTaskCounter->Release();
+}
+
+void H1TaskDeclaration::SkipTask()
+{
+	if (m_bRunWhenCancelled)
 	{
-		//@TODO - need to find more elegant way to process this
-		if (m_Parent == nullptr) // this task executes in the main thread
+		RunTask();
+		return;
+	}
+
+	// same as RunTask except the task-body
+	H1TaskCounter* pTaskCounter = m_TaskCounter;
+	if (m_bPooled)
+		H1TaskSchedulerLayer::GetTaskScheduler()->GetTaskDeclarationPool().Release(this);
+	if (pTaskCounter != nullptr)
+		pTaskCounter->Release();
+}
+
+namespace
+{
+	// the number of cancelled tokens; zero in the common case
+	std::atomic<int32_t> gCancelledTokenCounts(0);
+	// bumped whenever any token is cancelled or reset (invalidates the cached chain states)
+	std::atomic<uint32_t> gCancellationEpoch(1);
+}
+
+H1TaskCancellationToken::H1TaskCancellationToken(H1TaskCancellationToken* parent)
+	: m_bCancelled(false)
+	, m_Parent(parent)
+	, m_CachedChainState(0)
+{
+
+}
+
+H1TaskCancellationToken::~H1TaskCancellationToken()
+{
+	// the destroyed token is not cancelled anymore
+	Reset();
+}
+
+void H1TaskCancellationToken::Cancel()
+{
+	if (m_bCancelled.exchange(true, std::memory_order_acq_rel))
+		return;
+	gCancelledTokenCounts.fetch_add(1, std::memory_order_release);
+	gCancellationEpoch.fetch_add(1, std::memory_order_release);
+}
+
+void H1TaskCancellationToken::Reset()
+{
+	if (!m_bCancelled.exchange(false, std::memory_order_acq_rel))
+		return;
+	gCancellationEpoch.fetch_add(1, std::memory_order_release);
+	gCancelledTokenCounts.fetch_sub(1, std::memory_order_release);
+}
+
+bool H1TaskCancellationToken::IsAnyCancelled()
+{
+	return gCancelledTokenCounts.load(std::memory_order_acquire) != 0;
+}
+
+bool H1TaskCancellationToken::IsCancelled() const
+{
+	if (!IsAnyCancelled())
+		return false;
+
+	// the chain hasn't changed since the last walk
+	uint32_t epoch = gCancellationEpoch.load(std::memory_order_acquire);
+	uint64_t cachedChainState = m_CachedChainState.load(std::memory_order_relaxed);
+	if (static_cast<uint32_t>(cachedChainState >> 1) == epoch)
+		return (cachedChainState & 1) != 0;
+
+	bool bCancelled = false;
+	for (const H1TaskCancellationToken* token = this; token != nullptr; token = token->m_Parent)
+	{
+		if (token->m_bCancelled.load(std::memory_order_acquire))
 		{
-			return;
+			bCancelled = true;
+			break;
 		}
-
-		FiberId fiberId = m_Parent->m_Owner->GetFiberId();
-		EFiberType fiberType = m_Parent->m_Owner->GetFiberType();
-		// @TODO - need to think about this... how to make it more elegant
-		H1TaskSchedulerLayer::GetTaskScheduler()->GetWaitFiberContextQueue().MoveToReadyToResumeQueue(fiberId, fiberType);
 	}
+	// the stale store is harmless; its epoch doesn't match the later polls
+	m_CachedChainState.store((static_cast<uint64_t>(epoch) << 1) | (bCancelled ? 1 : 0), std::memory_order_relaxed);
+	return bCancelled;
 }
 
+// marker of the waiter and the continuations released by the counter reaching zero (never dereferenced)
+static char gReleasedMarker;
+static inline H1FiberContext* ReleasedFiberContext() { return reinterpret_cast<H1FiberContext*>(&gReleasedMarker); }
+static inline H1TaskDeclaration* ReleasedContinuations() { return reinterpret_cast<H1TaskDeclaration*>(&gReleasedMarker); }
+
 H1TaskCounter::H1TaskCounter()
 	: m_RemainCounter(0)
+	, m_WaitingFiberContext(ReleasedFiberContext())
+	, m_Continuations(ReleasedContinuations())
 {
 
 }
 
 H1TaskCounter::TaskCounterType H1TaskCounter::FetchAndAdd(TaskCounterType value)
 {
-	return m_RemainCounter.fetch_add(value);
+	// don't re-arm the counter while the last task is releasing it
+	TaskCounterType prevValue = m_RemainCounter.load();
+	do
+	{
+		while (IsReleasing(prevValue))
+			prevValue = m_RemainCounter.load();
+	} while (!m_RemainCounter.compare_exchange_weak(prevValue, prevValue + value));
+
+	if (prevValue == 0 && value > 0)
+		ClearReleasedStates();
+	return prevValue;
 }
 
 H1TaskCounter::TaskCounterType H1TaskCounter::Reset(TaskCounterType value)
 {
+	assert(!IsReleasing(m_RemainCounter.load()) && "[invalid] the counter is reset while it is released");
+	H1TaskDeclaration* pContinuations = m_Continuations.load();
+	assert((pContinuations == nullptr || pContinuations == ReleasedContinuations()) && "[invalid] the counter is reset with the pending continuations");
+
 	m_RemainCounter.store(value);
+	if (value == 0)
+	{
+		m_WaitingFiberContext.store(ReleasedFiberContext());
+		m_Continuations.store(ReleasedContinuations());
+	}
+	else
+	{
+		ClearReleasedStates();
+	}
 	return m_RemainCounter.load();
 }
 
+void H1TaskCounter::ClearReleasedStates()
+{
+	H1FiberContext* pExpectedFiberContext = ReleasedFiberContext();
+	m_WaitingFiberContext.compare_exchange_strong(pExpectedFiberContext, nullptr);
+	H1TaskDeclaration* pExpectedContinuations = ReleasedContinuations();
+	m_Continuations.compare_exchange_strong(pExpectedContinuations, nullptr);
+}
+
 H1TaskCounter::TaskCounterType H1TaskCounter::Decrement()
 {
-	--m_RemainCounter;
-	return m_RemainCounter.load();
+	// return the decremented value atomically; only one decrement could see zero
+	return --m_RemainCounter;
 }
 
 H1TaskCounter::TaskCounterType H1TaskCounter::Get()
 {
-	return m_RemainCounter.load();
-}
\ No newline at end of file
+	TaskCounterType value = m_RemainCounter.load();
+	// the last task is releasing the counter; it becomes zero in a moment
+	while (IsReleasing(value))
+		value = m_RemainCounter.load();
+	return value;
+}
+
+H1TaskCounter::TaskCounterType H1TaskCounter::Release()
+{
+	TaskCounterType value = m_RemainCounter.load();
+	while (true)
+	{
+		if (value == 1)
+		{
+			// the last task; mark the counter as releasing instead of zero
+			if (m_RemainCounter.compare_exchange_weak(value, ReleasingBias))
+				break;
+		}
+		else if (m_RemainCounter.compare_exchange_weak(value, value - 1))
+		{
+			return value - 1;
+		}
+	}
+
+	// take the waiter and the continuations; the ones registering after here see the released marker and run by themselves
+	H1FiberContext* pWaitingFiberContext = m_WaitingFiberContext.exchange(ReleasedFiberContext());
+	H1TaskDeclaration* pContinuations = m_Continuations.exchange(ReleasedContinuations());
+
+	// now the counter reaches zero; after here, don't touch this counter (it could be destroyed by the waiter or the continuations)
+	m_RemainCounter.fetch_sub(ReleasingBias);
+
+	if (pContinuations != nullptr && pContinuations != ReleasedContinuations())
+		ReleaseContinuations(pContinuations);
+
+	if (pWaitingFiberContext != nullptr && pWaitingFiberContext != ReleasedFiberContext())
+		H1TaskSchedulerLayer::ResumeFiber(pWaitingFiberContext);
+
+	return 0;
+}
+
+bool H1TaskCounter::SetWaitingFiberContext(H1FiberContext* pFiberContext)
+{
+	H1FiberContext* pExpected = nullptr;
+	if (m_WaitingFiberContext.compare_exchange_strong(pExpected, pFiberContext))
+		return true;
+
+	assert(pExpected == ReleasedFiberContext() && "[invalid] another fiber context already waits for this counter");
+	return false;
+}
+
+bool H1TaskCounter::AddContinuations(H1TaskDeclaration* head, H1TaskDeclaration* tail)
+{
+	// push the linked tasks at once; the released marker means the counter already reached zero
+	H1TaskDeclaration* oldHead = m_Continuations.load();
+	do
+	{
+		if (oldHead == ReleasedContinuations())
+		{
+			tail->SetNext(nullptr);
+			return false;
+		}
+		tail->SetNext(oldHead);
+	} while (!m_Continuations.compare_exchange_weak(oldHead, head));
+	return true;
+}
+
+void H1TaskCounter::ReleaseContinuations(H1TaskDeclaration* pTasks)
+{
+	// @TODO - temporary enqueue into high-priority queue
+	H1TaskScheduler* pTaskScheduler = H1TaskSchedulerLayer::GetTaskScheduler();
+	H1TaskDeclaration* pTask = pTasks;
+	while (pTask != nullptr)
+	{
+		// get next before enqueueing; the task could be executed and reused right after enqueued
+		H1TaskDeclaration* pNextTask = pTask->GetNext();
+		pTask->SetNext(nullptr);
+		pTaskScheduler->EnqueueTask(pTask, ETQP_High);
+		pTask = pNextTask;
+	}
+}
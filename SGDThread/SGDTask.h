@@ -26,9 +26,18 @@
 namespace SGD
 {
 	typedef void (*TaskEntryPoint)(void* pTaskData);
+
+	enum ETaskQueuePriority
+	{
+		ETQP_High,
+		ETQP_Mid,
+		ETQP_Low,
+		ETQP_Max,
+	};
 	
 	// forward declaration
 	class H1FiberContext;
+	class H1TaskDeclaration;
 
 	class H1TaskCounter
 	{
@@ -38,13 +47,71 @@ namespace SGD
 		H1TaskCounter();
 
 		//@TODO - further optimization with memory access flags
+		// re-arming the counter from zero clears the released state of the waiter and the continuations
+		//	- NOTE THAT - registering the waiter (or the continuations) racing with re-arming could be released by either generation
 		TaskCounterType FetchAndAdd(TaskCounterType value);
 		TaskCounterType Reset(TaskCounterType value);
 		TaskCounterType Decrement();
+		// when the last task is releasing the counter, Get() waits until it finishes (the counter could be destroyed right after zero)
 		TaskCounterType Get();
 
+		// decrement by finished task; the decrement reaching zero enqueues continuations and resumes the waiting fiber
+		//	- the waiter and the continuations are taken before the counter reaches zero, and enqueued without touching the counter after it
+		TaskCounterType Release();
+
+		// waiting fiber context (only one fiber could wait for the counter at once)
+		//	- it is resumed by Release() reaching zero
+		//	- return false when the counter already reached zero (resume it by yourself); after it returns true, don't touch the counter
+		//	  (the resumed fiber could destroy it)
+		bool SetWaitingFiberContext(H1FiberContext* pFiberContext);
+
+		// continuations are enqueued by the decrement which makes the counter reach zero
+		//	- tasks are linked from head to tail by H1TaskDeclaration::m_Next
+		//	- return false when the counter already reached zero (enqueue them by ReleaseContinuations); after it returns true, don't touch the counter
+		bool AddContinuations(H1TaskDeclaration* head, H1TaskDeclaration* tail);
+		// enqueue the linked continuation tasks
+		static void ReleaseContinuations(H1TaskDeclaration* pTasks);
+
 	private:
+		// while the last task releases the counter, the bias is added to the remain counter
+		static const TaskCounterType ReleasingBias = (1 << 30);
+		static bool IsReleasing(TaskCounterType value) { return value >= ReleasingBias / 2; }
+
 		std::atomic<TaskCounterType> m_RemainCounter;
+		// re-arm the waiter and the continuations released by the last generation
+		void ClearReleasedStates();
+
+		// fiber context waiting for this counter to reach zero (or the released marker)
+		std::atomic<H1FiberContext*> m_WaitingFiberContext;
+		// lock-free list of continuation tasks waiting for this counter to reach zero (or the released marker)
+		std::atomic<H1TaskDeclaration*> m_Continuations;
+	};
+
+	// cooperative cancellation token
+	//	- cancelling the token cancels the tokens created with it as parent (the check walks the parent chain)
+	//	- tasks without own token inherit the token of the parent task when they are spawned
+	//	- the poll is one load while no token is cancelled; otherwise the result of the chain walk is cached
+	//	  until any token is cancelled or reset again
+	class H1TaskCancellationToken
+	{
+	public:
+		H1TaskCancellationToken(H1TaskCancellationToken* parent = nullptr);
+		~H1TaskCancellationToken();
+
+		void Cancel();
+		void Reset();
+		bool IsCancelled() const;
+
+		inline H1TaskCancellationToken* GetParent() const { return m_Parent; }
+
+		// false when no token is cancelled (the polling skips looking up the token)
+		static bool IsAnyCancelled();
+
+	private:
+		std::atomic<bool> m_bCancelled;
+		H1TaskCancellationToken* m_Parent;
+		// (cancellation epoch << 1) | cancelled state of the chain, at the last walk
+		mutable std::atomic<uint64_t> m_CachedChainState;
 	};
 
 	class H1TaskDeclaration
@@ -56,10 +123,37 @@ namespace SGD
 		void SetTaskCounter(H1TaskCounter* counter);
 		void SetTaskData(void* data);
 		void SetTaskEntryPoint(TaskEntryPoint taskBody);
+		void SetCancellationToken(H1TaskCancellationToken* token);
 		void RunTask();
+		// finish the cancelled task without executing the task-body (the task counter still reaches zero)
+		void SkipTask();
+		// reset all states for reusing the declaration (e.g. H1TaskDeclarationPool)
+		void Reset(TaskEntryPoint taskBody = nullptr, void* taskData = nullptr);
+
+		// own token or the token inherited from the parent task
+		inline H1TaskCancellationToken* GetCancellationToken() const { return m_CancellationToken != nullptr ? m_CancellationToken : m_InheritedCancellationToken; }
+		inline void SetInheritedCancellationToken(H1TaskCancellationToken* token) { m_InheritedCancellationToken = token; }
+		inline bool IsCancelled() const { H1TaskCancellationToken* token = GetCancellationToken(); return token != nullptr && token->IsCancelled(); }
+		// optional deadline (timestamp by appGetTimestamp, 0 means no deadline)
+		//	- the tasks with the deadline are scheduled earliest-deadline-first before the priority queues
+		inline void SetDeadline(uint64_t deadline) { m_Deadline = deadline; }
+		inline uint64_t GetDeadline() const { return m_Deadline; }
+		inline bool HasDeadline() const { return m_Deadline != 0; }
+		// the task-body handles cancellation by itself (e.g. H1TaskGraph releasing successors); SkipTask() still executes it
+		inline void SetRunWhenCancelled(bool bRunWhenCancelled) { m_bRunWhenCancelled = bRunWhenCancelled; }
+		// the declaration from H1TaskDeclarationPool is returned to the pool after it finishes
+		inline void SetPooled(bool bPooled) { m_bPooled = bPooled; }
+		inline bool IsPooled() const { return m_bPooled; }
+		// priority queue the task was enqueued into last (ETaskQueuePriority); the task put back is enqueued at the same priority
+		inline void SetQueuePriority(uint8_t tqPriority) { m_QueuePriority = tqPriority; }
+		inline ETaskQueuePriority GetQueuePriority() const { return static_cast<ETaskQueuePriority>(m_QueuePriority); }
 
 		// inline functionalities
 		inline void SetFiberContext(H1FiberContext* pFiberContext) { m_Owner = pFiberContext; }
+		inline H1TaskDeclaration* GetNext() { return m_Next; }
+		inline void SetNext(H1TaskDeclaration* next) { m_Next = next; }
+		inline H1TaskDeclaration* GetQueueNext() const { return m_QueueNext; }
+		inline void SetQueueNext(H1TaskDeclaration* next) { m_QueueNext = next; }
 
 	private:
 		// fiber context has task slot for this instance
@@ -71,7 +165,22 @@ namespace SGD
 		TaskEntryPoint m_TaskBody;
 		void* m_TaskData;
 		// reference for task-counter in H1FiberContext which spawned this task
+		//	- it could be null for the task nobody waits for (e.g. continuation without counter)
 		H1TaskCounter* m_TaskCounter;
+		// intrusive link (e.g. continuation list of H1TaskCounter)
+		H1TaskDeclaration* m_Next;
+		// cancellation token (own one and the one inherited from the parent when it is spawned)
+		H1TaskCancellationToken* m_CancellationToken;
+		H1TaskCancellationToken* m_InheritedCancellationToken;
+		bool m_bRunWhenCancelled;
+		// deadline timestamp (0 means no deadline)
+		uint64_t m_Deadline;
+		// owned by H1TaskDeclarationPool
+		bool m_bPooled;
+		// ETaskQueuePriority
+		uint8_t m_QueuePriority;
+		// intrusive link of H1IntrusiveTaskQueue (separated from m_Next; the continuation list is linked while it is not queued)
+		H1TaskDeclaration* m_QueueNext;
 	};
 }
 
@@ -0,0 +1,129 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDTaskCoroutine.h"
+
+#if SGD_COROUTINE_SUPPORT
+using namespace SGD;
+
+// task entry point for resuming the coroutine
+static void CoroutineResumeEntryPoint(void* pTaskData)
+{
+	H1CoroutineTask::HandleType::from_address(pTaskData).resume();
+}
+
+H1CoroutineTask::promise_type::promise_type()
+	: CompletionCounter(nullptr)
+{
+	ResumeTask.SetTaskEntryPoint(CoroutineResumeEntryPoint);
+}
+
+H1CoroutineTask H1CoroutineTask::promise_type::get_return_object()
+{
+	HandleType handle = HandleType::from_promise(*this);
+	ResumeTask.SetTaskData(handle.address());
+	return H1CoroutineTask(handle);
+}
+
+void H1CoroutineTask::promise_type::FinalAwaiter::await_suspend(coro::coroutine_handle<promise_type> handle) noexcept
+{
+	// the frame is destroyed before releasing the counter; the waiter could exit right after the counter reaches zero
+	H1TaskCounter* pCompletionCounter = handle.promise().CompletionCounter;
+	handle.destroy();
+
+	if (pCompletionCounter != nullptr)
+		pCompletionCounter->Release();
+}
+
+H1CoroutineTask::H1CoroutineTask()
+{
+
+}
+
+H1CoroutineTask::H1CoroutineTask(HandleType handle)
+	: m_Handle(handle)
+{
+
+}
+
+H1CoroutineTask::H1CoroutineTask(H1CoroutineTask&& other)
+	: m_Handle(other.Detach())
+{
+
+}
+
+H1CoroutineTask& H1CoroutineTask::operator=(H1CoroutineTask&& other)
+{
+	if (this != &other)
+	{
+		if (m_Handle)
+			m_Handle.destroy();
+		m_Handle = other.Detach();
+	}
+	return *this;
+}
+
+H1CoroutineTask::~H1CoroutineTask()
+{
+	// never spawned coroutine frame
+	if (m_Handle)
+		m_Handle.destroy();
+}
+
+H1CoroutineTask::HandleType H1CoroutineTask::Detach()
+{
+	HandleType handle = m_Handle;
+	m_Handle = HandleType();
+	return handle;
+}
+
+void H1TaskCounterAwaiter::await_suspend(H1CoroutineTask::HandleType handle)
+{
+	// if the counter already reaches zero, the resume task is enqueued immediately
+	//	- NOTE THAT - the coroutine could be resumed in other worker before this method returns; don't touch the frame here
+	H1TaskSchedulerLayer::RunTasksAfter(m_pTaskCounter, &handle.promise().ResumeTask, 1, nullptr);
+}
+
+bool SGD::RunCoroutineTask(H1CoroutineTask coroutineTask, H1TaskCounter* pTaskCounter)
+{
+	H1TaskScheduler* pTaskScheduler = H1TaskSchedulerLayer::GetTaskScheduler();
+	if (pTaskScheduler == nullptr || !coroutineTask.IsValid())
+		return false;
+
+	H1CoroutineTask::HandleType handle = coroutineTask.Detach();
+	H1CoroutineTask::promise_type& promise = handle.promise();
+
+	promise.CompletionCounter = pTaskCounter;
+	if (pTaskCounter != nullptr)
+		pTaskCounter->FetchAndAdd(1);
+
+	// start the coroutine through the task queue
+	promise.ResumeTask.SetTaskCounter(nullptr);
+	promise.ResumeTask.SetParent(nullptr);
+	// @TODO - temporary enqueue into high-priority queue
+	pTaskScheduler->EnqueueTask(&promise.ResumeTask, ETQP_High);
+
+	return true;
+}
+#endif
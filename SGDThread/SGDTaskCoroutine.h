@@ -0,0 +1,115 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDTaskScheduler.h"
+
+#if SGD_COROUTINE_SUPPORT
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+namespace SGD { namespace coro = std; }
+#else
+#include <exception>
+#include <experimental/coroutine>
+namespace SGD { namespace coro = std::experimental; }
+#endif
+
+namespace SGD
+{
+	// stackless coroutine task
+	//	- 'co_await counter' suspends only the coroutine frame (no fiber context is pinned while waiting)
+	//	- the coroutine is resumed by its resume task going through the task queues (same as other tasks)
+	//	- NOTE THAT - the coroutine could move between fibers at each suspension; use RunTasksWithCounter (not RunTasks) to spawn child tasks
+	class H1CoroutineTask
+	{
+	public:
+		struct promise_type
+		{
+			promise_type();
+
+			H1CoroutineTask get_return_object();
+			// the coroutine starts when it is spawned by RunCoroutineTask
+			coro::suspend_always initial_suspend() { return coro::suspend_always(); }
+			// destroy the frame and release the completion counter
+			struct FinalAwaiter
+			{
+				bool await_ready() noexcept { return false; }
+				void await_suspend(coro::coroutine_handle<promise_type> handle) noexcept;
+				void await_resume() noexcept {}
+			};
+			FinalAwaiter final_suspend() noexcept { return FinalAwaiter(); }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+#if !defined(__cpp_impl_coroutine)
+			// '/await' of the older toolsets (e.g. v140) reports the exception through set_exception
+			void set_exception(std::exception_ptr) { std::terminate(); }
+#endif
+
+			// task declaration resuming this coroutine (its task data is the coroutine handle)
+			H1TaskDeclaration ResumeTask;
+			// released when the coroutine is finished (could be null)
+			H1TaskCounter* CompletionCounter;
+		};
+		typedef coro::coroutine_handle<promise_type> HandleType;
+
+		H1CoroutineTask();
+		explicit H1CoroutineTask(HandleType handle);
+		H1CoroutineTask(H1CoroutineTask&& other);
+		H1CoroutineTask& operator=(H1CoroutineTask&& other);
+		~H1CoroutineTask();
+
+		// release the ownership of the coroutine frame (the frame destroys itself when it is finished)
+		HandleType Detach();
+		inline bool IsValid() const { return static_cast<bool>(m_Handle); }
+
+	private:
+		H1CoroutineTask(const H1CoroutineTask&) = delete;
+		H1CoroutineTask& operator=(const H1CoroutineTask&) = delete;
+
+		// coroutine frame before spawned
+		HandleType m_Handle;
+	};
+
+	// awaiter for 'co_await counter' in H1CoroutineTask
+	class H1TaskCounterAwaiter
+	{
+	public:
+		explicit H1TaskCounterAwaiter(H1TaskCounter* pTaskCounter)
+			: m_pTaskCounter(pTaskCounter)
+		{}
+
+		bool await_ready() { return m_pTaskCounter->Get() == 0; }
+		// resume task is attached as continuation of the counter
+		void await_suspend(H1CoroutineTask::HandleType handle);
+		void await_resume() {}
+
+	private:
+		H1TaskCounter* m_pTaskCounter;
+	};
+
+	inline H1TaskCounterAwaiter operator co_await(H1TaskCounter& taskCounter) { return H1TaskCounterAwaiter(&taskCounter); }
+
+	// spawn the coroutine task; pTaskCounter (optional) is incremented now and released when the coroutine is finished
+	bool RunCoroutineTask(H1CoroutineTask coroutineTask, H1TaskCounter* pTaskCounter = nullptr);
+}
+#endif
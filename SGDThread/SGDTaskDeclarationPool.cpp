@@ -0,0 +1,149 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDTaskDeclarationPool.h"
+#include "SGDWorkerThread.h"
+using namespace SGD;
+
+H1TaskDeclarationPool::H1TaskDeclarationPool()
+	: m_LocalFreeLists(nullptr)
+	, m_WorkerThreadCounts(0)
+	, m_AllocatedCounts(0)
+{
+
+}
+
+H1TaskDeclarationPool::~H1TaskDeclarationPool()
+{
+	Destroy();
+}
+
+bool H1TaskDeclarationPool::Initialize(uint32_t workerThreadCounts)
+{
+	m_WorkerThreadCounts = workerThreadCounts;
+	m_LocalFreeLists = reinterpret_cast<H1LocalFreeList*>(appAllocateAlignedMemory(sizeof(H1LocalFreeList) * workerThreadCounts, alignof(H1LocalFreeList)));
+	if (m_LocalFreeLists == nullptr)
+		return false;
+	// reserve free lists not to allocate memory while recycling declarations
+	for (uint32_t i = 0; i < workerThreadCounts; ++i)
+	{
+		new (&m_LocalFreeLists[i]) H1LocalFreeList();
+		m_LocalFreeLists[i].FreeTasks.reserve(MaxLocalFreeCounts);
+	}
+
+	return true;
+}
+
+void H1TaskDeclarationPool::Destroy()
+{
+	H1TaskDeclaration* pChunk = nullptr;
+	while (m_Chunks.try_dequeue(pChunk))
+		delete[] pChunk;
+
+	H1TaskDeclaration* pTask = nullptr;
+	while (m_SharedFreeTasks.try_dequeue(pTask)) {}
+
+	if (m_LocalFreeLists != nullptr)
+	{
+		for (uint32_t i = 0; i < m_WorkerThreadCounts; ++i)
+			m_LocalFreeLists[i].~H1LocalFreeList();
+		appFreeAlignedMemory(m_LocalFreeLists);
+		m_LocalFreeLists = nullptr;
+	}
+	m_AllocatedCounts = 0;
+}
+
+H1TaskDeclarationPool::H1LocalFreeList* H1TaskDeclarationPool::GetLocalFreeList()
+{
+	H1WorkerThread* pWorkerThread = H1WorkerThread::GetCurrentWorkerThread();
+	if (pWorkerThread == nullptr || m_LocalFreeLists == nullptr)
+		return nullptr;
+	return &m_LocalFreeLists[pWorkerThread->GetWorkerThreadIndex()];
+}
+
+H1TaskDeclaration* H1TaskDeclarationPool::AllocateChunk(H1LocalFreeList* pLocalFreeList)
+{
+	H1TaskDeclaration* pChunk = new H1TaskDeclaration[ChunkSize];
+	m_Chunks.enqueue(pChunk);
+	m_AllocatedCounts.fetch_add(ChunkSize, std::memory_order_relaxed);
+
+	// the first one is returned; rest of them are put into the free list
+	for (int32_t i = 1; i < ChunkSize; ++i)
+	{
+		pChunk[i].SetPooled(true);
+		if (pLocalFreeList != nullptr)
+			pLocalFreeList->FreeTasks.push_back(&pChunk[i]);
+		else
+			m_SharedFreeTasks.enqueue(&pChunk[i]);
+	}
+	return &pChunk[0];
+}
+
+H1TaskDeclaration* H1TaskDeclarationPool::Acquire()
+{
+	H1LocalFreeList* pLocalFreeList = GetLocalFreeList();
+	H1TaskDeclaration* pTask = nullptr;
+
+	if (pLocalFreeList != nullptr)
+	{
+		std::vector<H1TaskDeclaration*>& rFreeTasks = pLocalFreeList->FreeTasks;
+		if (rFreeTasks.empty())
+		{
+			// refill the free list from the shared queue at once
+			H1TaskDeclaration* refillTasks[ChunkSize];
+			size_t refillCounts = m_SharedFreeTasks.try_dequeue_bulk(refillTasks, ChunkSize);
+			rFreeTasks.insert(rFreeTasks.end(), refillTasks, refillTasks + refillCounts);
+		}
+
+		if (!rFreeTasks.empty())
+		{
+			pTask = rFreeTasks.back();
+			rFreeTasks.pop_back();
+		}
+	}
+	else
+	{
+		m_SharedFreeTasks.try_dequeue(pTask);
+	}
+
+	if (pTask == nullptr)
+		pTask = AllocateChunk(pLocalFreeList);
+
+	pTask->Reset();
+	pTask->SetPooled(true);
+	return pTask;
+}
+
+void H1TaskDeclarationPool::Release(H1TaskDeclaration* pTask)
+{
+	H1LocalFreeList* pLocalFreeList = GetLocalFreeList();
+	if (pLocalFreeList != nullptr && static_cast<int32_t>(pLocalFreeList->FreeTasks.size()) < MaxLocalFreeCounts)
+	{
+		pLocalFreeList->FreeTasks.push_back(pTask);
+		return;
+	}
+
+	// overflow (or not the worker thread); share it with other threads
+	m_SharedFreeTasks.enqueue(pTask);
+}
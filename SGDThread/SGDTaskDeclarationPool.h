@@ -0,0 +1,74 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDTask.h"
+
+namespace SGD
+{
+	// pool of task declarations for fire-and-forget tasks (see H1TaskSchedulerLayer::SpawnTask)
+	//	- each worker thread has own free list touched only by the worker thread (no lock, no atomic)
+	//	- the declaration is returned to the free list of the worker thread which finished it
+	//	- the free lists are balanced through the lock-free shared queue (overflow of the free list, or refill of the empty one)
+	//	- the thread which is not the worker thread (e.g. main thread) only uses the shared queue
+	class H1TaskDeclarationPool
+	{
+	public:
+		// declarations allocated at once when the pool runs out
+		static const int32_t ChunkSize = 64;
+		// free list size of each worker thread before it overflows to the shared queue
+		static const int32_t MaxLocalFreeCounts = 256;
+
+		H1TaskDeclarationPool();
+		~H1TaskDeclarationPool();
+
+		bool Initialize(uint32_t workerThreadCounts);
+		// NOTE THAT - all pooled tasks should be finished
+		void Destroy();
+
+		// the declaration is reset and marked as pooled
+		H1TaskDeclaration* Acquire();
+		void Release(H1TaskDeclaration* pTask);
+
+		inline int32_t GetAllocatedCounts() const { return m_AllocatedCounts.load(std::memory_order_relaxed); }
+
+	private:
+		// cache-line aligned to avoid false sharing with neighbor free list (the array is allocated with the alignment)
+		struct alignas(64) H1LocalFreeList
+		{
+			std::vector<H1TaskDeclaration*> FreeTasks;
+		};
+
+		// null in the thread which is not the worker thread
+		H1LocalFreeList* GetLocalFreeList();
+		H1TaskDeclaration* AllocateChunk(H1LocalFreeList* pLocalFreeList);
+
+		H1LocalFreeList* m_LocalFreeLists;
+		uint32_t m_WorkerThreadCounts;
+		// shared free declarations
+		moodycamel::ConcurrentQueue<H1TaskDeclaration*> m_SharedFreeTasks;
+		// allocated chunks (released in Destroy)
+		moodycamel::ConcurrentQueue<H1TaskDeclaration*> m_Chunks;
+		std::atomic<int32_t> m_AllocatedCounts;
+	};
+}
@@ -0,0 +1,63 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDTaskFuture.h"
+using namespace SGD;
+
+H1TaskCounter H1TaskFutureState::gCompletedMarker;
+
+H1TaskFutureState::H1TaskFutureState()
+	: m_CombinatorCounter(nullptr)
+{
+
+}
+
+bool H1TaskFutureState::RegisterCombinator(H1TaskCounter* pCombinatorCounter)
+{
+	H1TaskCounter* pExpected = nullptr;
+	if (m_CombinatorCounter.compare_exchange_strong(pExpected, pCombinatorCounter))
+		return true;
+
+	assert(pExpected == &gCompletedMarker && "[invalid] the future is already waited by other combinator");
+	return false;
+}
+
+bool H1TaskFutureState::UnregisterCombinator(H1TaskCounter* pCombinatorCounter)
+{
+	H1TaskCounter* pExpected = pCombinatorCounter;
+	return m_CombinatorCounter.compare_exchange_strong(pExpected, nullptr);
+}
+
+void H1TaskFutureState::ResetState()
+{
+	m_CombinatorCounter.store(nullptr);
+}
+
+void H1TaskFutureState::NotifyCompleted()
+{
+	// mark completed and release the combinator counter if exists
+	H1TaskCounter* pCombinatorCounter = m_CombinatorCounter.exchange(&gCompletedMarker);
+	if (pCombinatorCounter != nullptr && pCombinatorCounter != &gCompletedMarker)
+		pCombinatorCounter->Release();
+}
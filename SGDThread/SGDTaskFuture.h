@@ -0,0 +1,244 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDTaskScheduler.h"
+
+namespace SGD
+{
+	// non-typed part of the typed task: task declaration and its counter are co-located with the result
+	class H1TaskFutureState
+	{
+	public:
+		H1TaskFutureState();
+
+		inline H1TaskDeclaration& GetTaskDeclaration() { return m_Task; }
+		inline H1TaskCounter& GetTaskCounter() { return m_TaskCounter; }
+		// the result is stored (the task counter could still be releasing)
+		inline bool IsCompleted() const { return m_CombinatorCounter.load() == &gCompletedMarker; }
+
+		// combinator counter (WhenAll/WhenAny) is released by this task once the result is stored
+		//	- return false when the task is already completed
+		bool RegisterCombinator(H1TaskCounter* pCombinatorCounter);
+		//	- return false when the task already took the counter (it is released or being released by the task)
+		bool UnregisterCombinator(H1TaskCounter* pCombinatorCounter);
+
+	protected:
+		// prepare to spawn the task again
+		void ResetState();
+		// called by the task-body after storing the result
+		void NotifyCompleted();
+
+		// task declaration and counter waited by H1TaskFuture
+		H1TaskDeclaration m_Task;
+		H1TaskCounter m_TaskCounter;
+		// combinator counter waiting for this task (or gCompletedMarker)
+		std::atomic<H1TaskCounter*> m_CombinatorCounter;
+
+		static H1TaskCounter gCompletedMarker;
+	};
+
+	// typed task declaration - the result storage lives in the declaration (no separate allocation)
+	//	- the caller owns the declaration until the result is consumed (same as H1TaskDeclaration)
+	template<typename T>
+	class H1TypedTaskDeclaration : public H1TaskFutureState
+	{
+	public:
+		typedef T (*TypedTaskEntryPoint)(void* pTaskData);
+
+		H1TypedTaskDeclaration(TypedTaskEntryPoint taskBody = nullptr, void* taskData = nullptr)
+			: m_TypedTaskBody(taskBody)
+			, m_TypedTaskData(taskData)
+			, m_bHasResult(false)
+		{
+			m_Task.SetTaskEntryPoint(TypedTaskEntryPoint_Internal);
+			m_Task.SetTaskData(this);
+			// cancelled task completes without result (combinators should be released)
+			m_Task.SetRunWhenCancelled(true);
+		}
+
+		~H1TypedTaskDeclaration()
+		{
+			DestroyResult();
+		}
+
+		inline void SetTaskEntryPoint(TypedTaskEntryPoint taskBody) { m_TypedTaskBody = taskBody; }
+		inline void SetTaskData(void* data) { m_TypedTaskData = data; }
+
+		// prepare to spawn the task again
+		void Reset()
+		{
+			DestroyResult();
+			ResetState();
+		}
+
+		// only valid after the task counter reaches zero
+		inline T& GetResult() { assert(m_bHasResult && "[invalid] the task is cancelled"); return *reinterpret_cast<T*>(&m_Result); }
+		// false when the task is cancelled
+		inline bool HasResult() const { return m_bHasResult; }
+
+	private:
+		static void TypedTaskEntryPoint_Internal(void* pTaskData)
+		{
+			H1TypedTaskDeclaration<T>* pTask = reinterpret_cast<H1TypedTaskDeclaration<T>*>(pTaskData);
+			if (!pTask->m_Task.IsCancelled())
+			{
+				new (&pTask->m_Result) T(pTask->m_TypedTaskBody(pTask->m_TypedTaskData));
+				pTask->m_bHasResult = true;
+			}
+			pTask->NotifyCompleted();
+		}
+
+		void DestroyResult()
+		{
+			if (m_bHasResult)
+				GetResult().~T();
+			m_bHasResult = false;
+		}
+
+		TypedTaskEntryPoint m_TypedTaskBody;
+		void* m_TypedTaskData;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type m_Result;
+		bool m_bHasResult;
+	};
+
+	// future for the result of typed task
+	template<typename T>
+	class H1TaskFuture
+	{
+	public:
+		H1TaskFuture()
+			: m_pTask(nullptr)
+		{}
+
+		explicit H1TaskFuture(H1TypedTaskDeclaration<T>* pTask)
+			: m_pTask(pTask)
+		{}
+
+		inline bool IsValid() const { return m_pTask != nullptr; }
+		inline bool IsReady() const { return m_pTask->IsCompleted(); }
+		// the task is cancelled before producing the result (only valid after it is ready)
+		inline bool IsCancelled() const { return !m_pTask->HasResult(); }
+		inline H1TypedTaskDeclaration<T>* GetTask() { return m_pTask; }
+
+		// wait for the task without getting the result
+		void Wait()
+		{
+			H1TaskSchedulerLayer::WaitForCounter(&m_pTask->GetTaskCounter());
+		}
+
+		// wait for the task and get the result; the calling fiber is suspended by WaitForCounter (not spinning)
+		//	- NOTE THAT - only one fiber could wait for the same future at once
+		//	- check IsCancelled() before Get() when the task could be cancelled
+		T& Get()
+		{
+			Wait();
+			return m_pTask->GetResult();
+		}
+
+	private:
+		H1TypedTaskDeclaration<T>* m_pTask;
+	};
+
+	// spawn typed task and return the future for the result
+	template<typename T>
+	H1TaskFuture<T> RunTypedTask(H1TypedTaskDeclaration<T>& typedTask)
+	{
+		typedTask.Reset();
+		if (!H1TaskSchedulerLayer::RunTasksWithCounter(&typedTask.GetTaskDeclaration(), 1, &typedTask.GetTaskCounter()))
+			return H1TaskFuture<T>();
+		return H1TaskFuture<T>(&typedTask);
+	}
+
+	// wait until all futures are completed, suspending once on one combinator counter
+	template<typename T>
+	bool WhenAll(H1TaskFuture<T>* futures, int32_t futureCounts)
+	{
+		H1TaskCounter combinatorCounter;
+		combinatorCounter.Reset(futureCounts);
+
+		// completed tasks don't release the counter; release on behalf of them
+		for (int32_t i = 0; i < futureCounts; ++i)
+		{
+			if (!futures[i].GetTask()->RegisterCombinator(&combinatorCounter))
+				combinatorCounter.Release();
+		}
+
+		if (!H1TaskSchedulerLayer::WaitForCounter(&combinatorCounter))
+			return false;
+
+		// results are stored; wait for the task counters to be released
+		for (int32_t i = 0; i < futureCounts; ++i)
+			futures[i].Wait();
+
+		return true;
+	}
+
+	// wait until any of futures is completed; return the index of the completed future (-1 on failure)
+	//	- NOTE THAT - the future could be waited by only one combinator at once
+	template<typename T>
+	int32_t WhenAny(H1TaskFuture<T>* futures, int32_t futureCounts)
+	{
+		H1TaskCounter combinatorCounter;
+		combinatorCounter.Reset(1);
+
+		int32_t registeredCounts = 0;
+		bool bAlreadyCompleted = false;
+		for (; registeredCounts < futureCounts; ++registeredCounts)
+		{
+			if (!futures[registeredCounts].GetTask()->RegisterCombinator(&combinatorCounter))
+			{
+				bAlreadyCompleted = true;
+				break;
+			}
+		}
+
+		if (!bAlreadyCompleted)
+			H1TaskSchedulerLayer::WaitForCounter(&combinatorCounter);
+
+		// unregister the combinator counter; the task failed to unregister releases (or will release) the counter
+		int32_t releasedCounts = 0;
+		for (int32_t i = 0; i < registeredCounts; ++i)
+		{
+			if (!futures[i].GetTask()->UnregisterCombinator(&combinatorCounter))
+				++releasedCounts;
+		}
+
+		// wait for releasing tasks not to touch the combinator counter on this stack anymore
+		while (combinatorCounter.Get() != 1 - releasedCounts)
+			appYieldProcessor();
+
+		for (int32_t i = 0; i < futureCounts; ++i)
+		{
+			if (futures[i].IsReady())
+			{
+				futures[i].Wait();
+				return i;
+			}
+		}
+		return -1;
+	}
+}
+
+#define START_TYPED_TASK_ENTRY_POINT(ResultType, TaskName)			\
+ResultType TypedTaskEntryPoint_##TaskName(void* pTaskData_##TaskName)
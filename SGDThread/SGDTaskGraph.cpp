@@ -0,0 +1,230 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SGDThreadPCH.h"
+#include "SGDTaskGraph.h"
+#include "SGDTaskScheduler.h"
+using namespace SGD;
+
+H1TaskGraph::H1TaskGraph()
+	: m_bCompiled(false)
+	, m_RemainPredecessors(nullptr)
+{
+
+}
+
+H1TaskGraph::~H1TaskGraph()
+{
+	DestroyCompiledData();
+}
+
+H1TaskGraph::NodeId H1TaskGraph::AddNode(TaskEntryPoint taskBody, void* taskData)
+{
+	// adding node invalidates the compiled data
+	DestroyCompiledData();
+
+	H1TaskGraphNode newNode;
+	newNode.Graph = this;
+	newNode.Index = static_cast<NodeId>(m_Nodes.size());
+	newNode.TaskBody = taskBody;
+	newNode.TaskData = taskData;
+	newNode.SuccessorOffset = 0;
+	newNode.SuccessorCounts = 0;
+	newNode.PredecessorCounts = 0;
+	m_Nodes.push_back(newNode);
+
+	return newNode.Index;
+}
+
+bool H1TaskGraph::AddDependency(NodeId predecessor, NodeId successor)
+{
+	const NodeId nodeCounts = static_cast<NodeId>(m_Nodes.size());
+	if (predecessor < 0 || predecessor >= nodeCounts || successor < 0 || successor >= nodeCounts)
+		return false; // invalid node id
+	if (predecessor == successor)
+		return false; // self dependency is never resolved
+
+	// adding edge invalidates the compiled data
+	DestroyCompiledData();
+
+	m_Edges.push_back(std::make_pair(predecessor, successor));
+	return true;
+}
+
+void H1TaskGraph::Clear()
+{
+	DestroyCompiledData();
+	m_Nodes.clear();
+	m_Edges.clear();
+}
+
+bool H1TaskGraph::Compile()
+{
+	DestroyCompiledData();
+
+	const NodeId nodeCounts = static_cast<NodeId>(m_Nodes.size());
+
+	// 1. count successors and predecessors for each node
+	for (H1TaskGraphNode& node : m_Nodes)
+	{
+		node.SuccessorCounts = 0;
+		node.PredecessorCounts = 0;
+	}
+	for (const std::pair<NodeId, NodeId>& edge : m_Edges)
+	{
+		m_Nodes[edge.first].SuccessorCounts++;
+		m_Nodes[edge.second].PredecessorCounts++;
+	}
+
+	// 2. lay out successors into the flat array (prefix sum of successor counts)
+	int32_t offset = 0;
+	for (H1TaskGraphNode& node : m_Nodes)
+	{
+		node.SuccessorOffset = offset;
+		offset += node.SuccessorCounts;
+	}
+
+	m_Successors.resize(m_Edges.size());
+	std::vector<int32_t> fillCounts(nodeCounts, 0);
+	for (const std::pair<NodeId, NodeId>& edge : m_Edges)
+	{
+		H1TaskGraphNode& predecessorNode = m_Nodes[edge.first];
+		m_Successors[predecessorNode.SuccessorOffset + fillCounts[edge.first]++] = edge.second;
+	}
+
+	// 3. verify there is no cycle (Kahn's algorithm) and collect root nodes
+	std::vector<int32_t> remainCounts(nodeCounts);
+	std::vector<NodeId> readyNodes;
+	for (NodeId i = 0; i < nodeCounts; ++i)
+	{
+		remainCounts[i] = m_Nodes[i].PredecessorCounts;
+		if (remainCounts[i] == 0)
+		{
+			readyNodes.push_back(i);
+			m_RootNodes.push_back(i);
+		}
+	}
+
+	int32_t visitedCounts = 0;
+	while (!readyNodes.empty())
+	{
+		const H1TaskGraphNode& node = m_Nodes[readyNodes.back()];
+		readyNodes.pop_back();
+		++visitedCounts;
+
+		for (int32_t i = 0; i < node.SuccessorCounts; ++i)
+		{
+			NodeId successor = m_Successors[node.SuccessorOffset + i];
+			if (--remainCounts[successor] == 0)
+				readyNodes.push_back(successor);
+		}
+	}
+
+	if (visitedCounts != nodeCounts)
+	{
+		// there is a cycle in the graph
+		m_Successors.clear();
+		m_RootNodes.clear();
+		return false;
+	}
+
+	// 4. create task declarations with the trampoline for each node
+	m_Tasks.resize(nodeCounts);
+	for (NodeId i = 0; i < nodeCounts; ++i)
+	{
+		m_Tasks[i].SetTaskEntryPoint(NodeEntryPoint);
+		m_Tasks[i].SetTaskData(&m_Nodes[i]);
+		// cancelled node still releases its successors
+		m_Tasks[i].SetRunWhenCancelled(true);
+	}
+
+	m_RemainPredecessors = new std::atomic<int32_t>[nodeCounts];
+	for (NodeId i = 0; i < nodeCounts; ++i)
+		m_RemainPredecessors[i].store(0);
+
+	m_bCompiled = true;
+	return true;
+}
+
+bool H1TaskGraph::Run(H1TaskCounter** ppTaskCounter)
+{
+	if (!m_bCompiled)
+		return false; // compile the graph first
+
+	H1TaskScheduler* pTaskScheduler = H1TaskSchedulerLayer::GetTaskScheduler();
+	if (pTaskScheduler == nullptr)
+		return false;
+
+	// reset remain predecessor counts with precomputed values
+	const NodeId nodeCounts = static_cast<NodeId>(m_Nodes.size());
+	for (NodeId i = 0; i < nodeCounts; ++i)
+		m_RemainPredecessors[i].store(m_Nodes[i].PredecessorCounts, std::memory_order_relaxed);
+
+	// all nodes are counted at once; the counter reaches zero when the last node finishes
+	if (!H1TaskSchedulerLayer::BindTasks(m_Tasks.data(), nodeCounts, ppTaskCounter))
+		return false;
+
+	// only root nodes are enqueued; rest of nodes are enqueued by their last predecessor
+	// @TODO - temporary enqueue into high-priority queue
+	for (NodeId rootNode : m_RootNodes)
+		pTaskScheduler->EnqueueTask(&m_Tasks[rootNode], ETQP_High);
+
+	return true;
+}
+
+void H1TaskGraph::NodeEntryPoint(void* pTaskData)
+{
+	const H1TaskGraphNode* pNode = reinterpret_cast<const H1TaskGraphNode*>(pTaskData);
+
+	// execute user task-body (skip it when the graph run is cancelled)
+	H1TaskGraph* pGraph = pNode->Graph;
+	if (pNode->TaskBody != nullptr && !pGraph->m_Tasks[pNode->Index].IsCancelled())
+		pNode->TaskBody(pNode->TaskData);
+
+	// successors are released before this node decrements the task counter (in RunTask)
+	//	- so the counter never reaches zero while successors are not enqueued yet
+	pGraph->ReleaseSuccessors(*pNode);
+}
+
+void H1TaskGraph::ReleaseSuccessors(const H1TaskGraphNode& node)
+{
+	H1TaskScheduler* pTaskScheduler = H1TaskSchedulerLayer::GetTaskScheduler();
+	for (int32_t i = 0; i < node.SuccessorCounts; ++i)
+	{
+		NodeId successor = m_Successors[node.SuccessorOffset + i];
+		// the last predecessor makes the successor runnable
+		if (m_RemainPredecessors[successor].fetch_sub(1) == 1)
+			pTaskScheduler->EnqueueTask(&m_Tasks[successor], ETQP_High);
+	}
+}
+
+void H1TaskGraph::DestroyCompiledData()
+{
+	m_bCompiled = false;
+	m_Successors.clear();
+	m_RootNodes.clear();
+	m_Tasks.clear();
+
+	delete[] m_RemainPredecessors;
+	m_RemainPredecessors = nullptr;
+}
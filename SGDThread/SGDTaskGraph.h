@@ -0,0 +1,89 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "SGDTask.h"
+
+namespace SGD
+{
+	// task graph (DAG) which is built once and replayed every frame
+	//	- nodes are tasks and edges are dependencies (predecessor -> successor)
+	//	- Compile() flattens the graph into arrays with precomputed predecessor counts
+	//	- Run() only resets the remain counters and enqueues the root nodes (no allocation)
+	//	- the node becomes runnable when its last predecessor completes, so no fiber is parked to wait dependencies
+	class H1TaskGraph
+	{
+	public:
+		typedef int32_t NodeId;
+
+		H1TaskGraph();
+		~H1TaskGraph();
+
+		// building graph (invalidates the compiled state)
+		NodeId AddNode(TaskEntryPoint taskBody, void* taskData = nullptr);
+		bool AddDependency(NodeId predecessor, NodeId successor);
+		void Clear();
+
+		// flatten the graph; return false when the graph has a cycle
+		bool Compile();
+
+		// replay the compiled graph; ppTaskCounter is same as RunTasks (the counter reaches zero when all nodes finish)
+		// NOTE THAT - do not replay the graph until the previous run is finished (wait for the counter)
+		bool Run(H1TaskCounter** ppTaskCounter);
+
+		inline bool IsCompiled() const { return m_bCompiled; }
+		inline int32_t GetNodeCounts() const { return static_cast<int32_t>(m_Nodes.size()); }
+
+	private:
+		struct H1TaskGraphNode
+		{
+			H1TaskGraph* Graph;
+			NodeId Index;
+			// user task-body and data
+			TaskEntryPoint TaskBody;
+			void* TaskData;
+			// range of successors in m_Successors
+			int32_t SuccessorOffset;
+			int32_t SuccessorCounts;
+			// precomputed predecessor counts
+			int32_t PredecessorCounts;
+		};
+
+		// task entry point for all graph nodes (trampoline to user task-body)
+		static void NodeEntryPoint(void* pTaskData);
+		void ReleaseSuccessors(const H1TaskGraphNode& node);
+		void DestroyCompiledData();
+
+		// graph nodes
+		std::vector<H1TaskGraphNode> m_Nodes;
+		// edges (predecessor, successor) - only used until Compile()
+		std::vector<std::pair<NodeId, NodeId>> m_Edges;
+
+		// compiled data (flat arrays indexed by NodeId)
+		bool m_bCompiled;
+		std::vector<NodeId> m_Successors;
+		std::vector<NodeId> m_RootNodes;
+		std::vector<H1TaskDeclaration> m_Tasks;
+		std::atomic<int32_t>* m_RemainPredecessors;
+	};
+}
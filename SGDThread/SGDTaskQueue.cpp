@@ -23,25 +23,93 @@
 
 #include "SGDThreadPCH.h"
 #include "SGDTaskQueue.h"
+#include "SGDWorkerThread.h"
 using namespace SGD;
 
-H1TaskQueue::H1TaskQueue(ETaskQueuePriority priority)
+H1TaskQueue::H1TaskQueue(ETaskQueuePriority priority, uint32_t workerThreadCounts)
 	: m_Priority(priority)
+#if USE_BOUNDED_RING_QUEUE && !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE
+	, m_OverflowCounts(0)
+#endif
 {
-	
+#if USE_BOUNDED_RING_QUEUE && !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE
+	m_QueuedTasks.Initialize(BoundedQueueCapacity);
+#elif !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE
+	// tokens are bound to this queue, so they are created after the queue
+	m_ProducerTokens.resize(workerThreadCounts);
+	m_ConsumerTokens.resize(workerThreadCounts);
+	for (uint32_t i = 0; i < workerThreadCounts; ++i)
+	{
+		m_ProducerTokens[i] = new moodycamel::ProducerToken(m_QueuedTasks);
+		m_ConsumerTokens[i] = new moodycamel::ConsumerToken(m_QueuedTasks);
+	}
+#endif
 }
 
 H1TaskQueue::~H1TaskQueue()
 {
+#if !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE && !USE_BOUNDED_RING_QUEUE
+	// tokens should be released before the queue
+	for (uint32_t i = 0; i < m_ProducerTokens.size(); ++i)
+	{
+		delete m_ProducerTokens[i];
+		delete m_ConsumerTokens[i];
+	}
+	m_ProducerTokens.clear();
+	m_ConsumerTokens.clear();
+#endif
+}
 
+#if !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE && !USE_BOUNDED_RING_QUEUE
+moodycamel::ProducerToken* H1TaskQueue::GetProducerToken()
+{
+	// NOTE THAT - the token is only used by one thread at once; the fiber doesn't switch while it enqueues
+	H1WorkerThread* pWorkerThread = H1WorkerThread::GetCurrentWorkerThread();
+	if (pWorkerThread == nullptr || static_cast<uint32_t>(pWorkerThread->GetWorkerThreadIndex()) >= m_ProducerTokens.size())
+		return nullptr;
+	return m_ProducerTokens[pWorkerThread->GetWorkerThreadIndex()];
 }
 
+moodycamel::ConsumerToken* H1TaskQueue::GetConsumerToken()
+{
+	H1WorkerThread* pWorkerThread = H1WorkerThread::GetCurrentWorkerThread();
+	if (pWorkerThread == nullptr || static_cast<uint32_t>(pWorkerThread->GetWorkerThreadIndex()) >= m_ConsumerTokens.size())
+		return nullptr;
+	return m_ConsumerTokens[pWorkerThread->GetWorkerThreadIndex()];
+}
+#endif
+
+#if USE_BOUNDED_RING_QUEUE && !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE
+bool H1TaskQueue::DequeueOverflowTask(H1TaskDeclaration*& pTask)
+{
+	if (m_OverflowCounts.load(std::memory_order_acquire) <= 0)
+		return false;
+	pTask = m_OverflowTasks.DequeueTask();
+	if (pTask == nullptr)
+		return false;
+	m_OverflowCounts.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+#endif
+
 bool H1TaskQueue::EnqueueTask(H1TaskDeclaration* pTask)
 {
 #if USE_MS_CONCURRENT_QUEUE
 	m_QueuedTasks.push(pTask);
+#elif USE_INTRUSIVE_TASK_QUEUE
+	m_QueuedTasks.EnqueueTask(pTask);
+#elif USE_BOUNDED_RING_QUEUE
+	// the ring is full (spinning here could deadlock when the consumers are the producers), or the spilled tasks are ahead
+	if (m_OverflowCounts.load(std::memory_order_acquire) > 0 || !m_QueuedTasks.TryEnqueue(pTask))
+	{
+		m_OverflowCounts.fetch_add(1, std::memory_order_release);
+		m_OverflowTasks.EnqueueTask(pTask);
+	}
 #else
-	m_QueuedTasks.enqueue(pTask);
+	moodycamel::ProducerToken* pProducerToken = GetProducerToken();
+	bool bSuccess = (pProducerToken != nullptr) ? m_QueuedTasks.enqueue(*pProducerToken, pTask) : m_QueuedTasks.enqueue(pTask);
+	if (!bSuccess)
+		return false; // additional memory allocation failed (not enough memory)
 #endif
 	// successfully enqueue the task
 	return true;
@@ -49,18 +117,34 @@ bool H1TaskQueue::EnqueueTask(H1TaskDeclaration* pTask)
 
 bool H1TaskQueue::EnqueueTaskRange(H1TaskDeclaration* tasks, int32_t taskCounts)
 {
-	// @TODO - why try_enqueue_bulk is not working?
-	//if (!m_QueuedTasks.try_enqueue_bulk(&tasks, taskCounts))
-	//	return false; // additional memory allocation failed (not enough memory)
+#if USE_MS_CONCURRENT_QUEUE
 	for (int32_t taskIdx = 0; taskIdx < taskCounts; ++taskIdx)
+		m_QueuedTasks.push(&tasks[taskIdx]);
+#elif USE_INTRUSIVE_TASK_QUEUE
+	// one CAS splicing pre-linked tasks
+	m_QueuedTasks.EnqueueTaskRange(tasks, taskCounts);
+#elif USE_BOUNDED_RING_QUEUE
+	int32_t taskIdx = 0;
+	if (m_OverflowCounts.load(std::memory_order_acquire) <= 0)
 	{
-		H1TaskDeclaration* task = &tasks[taskIdx];
-#if USE_MS_CONCURRENT_QUEUE
-		m_QueuedTasks.push(task);
+		while (taskIdx < taskCounts && m_QueuedTasks.TryEnqueue(&tasks[taskIdx]))
+			++taskIdx;
+	}
+	if (taskIdx < taskCounts)
+	{
+		// spill the rest to the overflow at once
+		m_OverflowCounts.fetch_add(taskCounts - taskIdx, std::memory_order_release);
+		m_OverflowTasks.EnqueueTaskRange(&tasks[taskIdx], taskCounts - taskIdx);
+	}
 #else
-		m_QueuedTasks.enqueue(task);
+	// enqueue the addresses of the tasks (not the address of the array)
+	moodycamel::ProducerToken* pProducerToken = GetProducerToken();
+	bool bSuccess = (pProducerToken != nullptr)
+		? m_QueuedTasks.enqueue_bulk(*pProducerToken, H1TaskPointerIterator(tasks), taskCounts)
+		: m_QueuedTasks.enqueue_bulk(H1TaskPointerIterator(tasks), taskCounts);
+	if (!bSuccess)
+		return false; // additional memory allocation failed (not enough memory)
 #endif
-	}
 
 	// successfully enqueue the task
 	return true;
@@ -71,9 +155,43 @@ H1TaskDeclaration* H1TaskQueue::DequeueTask()
 	H1TaskDeclaration* pDequeuedTask = nullptr;
 #if USE_MS_CONCURRENT_QUEUE
 	if (!m_QueuedTasks.try_pop(pDequeuedTask))
+#elif USE_INTRUSIVE_TASK_QUEUE
+	pDequeuedTask = m_QueuedTasks.DequeueTask();
+	if (pDequeuedTask == nullptr)
+#elif USE_BOUNDED_RING_QUEUE
+	if (!m_QueuedTasks.TryDequeue(pDequeuedTask) && !DequeueOverflowTask(pDequeuedTask))
 #else
-	if (!m_QueuedTasks.try_dequeue(pDequeuedTask))
+	moodycamel::ConsumerToken* pConsumerToken = GetConsumerToken();
+	bool bSuccess = (pConsumerToken != nullptr) ? m_QueuedTasks.try_dequeue(*pConsumerToken, pDequeuedTask) : m_QueuedTasks.try_dequeue(pDequeuedTask);
+	if (!bSuccess)
 #endif
 		return nullptr; // if the queue is empty, return nullptr
 	return pDequeuedTask;
 }
+
+int32_t H1TaskQueue::DequeueTaskBulk(H1TaskDeclaration** ppTasks, int32_t maxTaskCounts)
+{
+#if USE_MS_CONCURRENT_QUEUE
+	int32_t dequeuedCounts = 0;
+	while (dequeuedCounts < maxTaskCounts && m_QueuedTasks.try_pop(ppTasks[dequeuedCounts]))
+		++dequeuedCounts;
+	return dequeuedCounts;
+#elif USE_INTRUSIVE_TASK_QUEUE
+	return m_QueuedTasks.DequeueTaskBulk(ppTasks, maxTaskCounts);
+#elif USE_BOUNDED_RING_QUEUE
+	int32_t dequeuedCounts = m_QueuedTasks.TryDequeueBulk(ppTasks, maxTaskCounts);
+	if (dequeuedCounts < maxTaskCounts && m_OverflowCounts.load(std::memory_order_acquire) > 0)
+	{
+		int32_t overflowCounts = m_OverflowTasks.DequeueTaskBulk(ppTasks + dequeuedCounts, maxTaskCounts - dequeuedCounts);
+		m_OverflowCounts.fetch_sub(overflowCounts, std::memory_order_relaxed);
+		dequeuedCounts += overflowCounts;
+	}
+	return dequeuedCounts;
+#else
+	moodycamel::ConsumerToken* pConsumerToken = GetConsumerToken();
+	size_t dequeuedCounts = (pConsumerToken != nullptr)
+		? m_QueuedTasks.try_dequeue_bulk(*pConsumerToken, ppTasks, maxTaskCounts)
+		: m_QueuedTasks.try_dequeue_bulk(ppTasks, maxTaskCounts);
+	return static_cast<int32_t>(dequeuedCounts);
+#endif
+}
\ No newline at end of file
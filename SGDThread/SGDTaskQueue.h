@@ -22,37 +22,76 @@
 // EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "SGDTask.h"
+#if USE_INTRUSIVE_TASK_QUEUE
+#include "SGDIntrusiveTaskQueue.h"
+#elif USE_BOUNDED_RING_QUEUE
+#include "SGDBoundedQueue.h"
+#include "SGDIntrusiveTaskQueue.h"
+#endif
 
 namespace SGD
 {
-	enum ETaskQueuePriority
+	// iterator over the addresses of contiguous task declarations (bulk enqueue of H1TaskDeclaration array)
+	class H1TaskPointerIterator
 	{
-		ETQP_High,
-		ETQP_Mid,
-		ETQP_Low,
-		ETQP_Max,
+	public:
+		explicit H1TaskPointerIterator(H1TaskDeclaration* pTask) : m_pTask(pTask) {}
+
+		inline H1TaskDeclaration* operator*() const { return m_pTask; }
+		inline H1TaskPointerIterator& operator++() { ++m_pTask; return *this; }
+		inline H1TaskPointerIterator operator++(int) { H1TaskPointerIterator prevIterator(*this); ++m_pTask; return prevIterator; }
+
+	private:
+		H1TaskDeclaration* m_pTask;
 	};
 
 	// the wrapper for concurrent task queue
+	//	- each worker thread has own producer/consumer token (the thread which is not the worker thread uses implicit one)
 	class H1TaskQueue
 	{
 	public:
-		H1TaskQueue(ETaskQueuePriority priority);
+		H1TaskQueue(ETaskQueuePriority priority, uint32_t workerThreadCounts = 0);
 		~H1TaskQueue();
 
 		bool EnqueueTask(H1TaskDeclaration* pTask);
 		H1TaskDeclaration* DequeueTask();
 
+		// enqueue the tasks at once (single reservation in the queue)
 		bool EnqueueTaskRange(H1TaskDeclaration* tasks, int32_t taskCounts);
+		// dequeue tasks up to maxTaskCounts at once; return the number of dequeued tasks
+		int32_t DequeueTaskBulk(H1TaskDeclaration** ppTasks, int32_t maxTaskCounts);
 
 	private:
+#if !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE && !USE_BOUNDED_RING_QUEUE
+		// null in the thread which is not the worker thread
+		moodycamel::ProducerToken* GetProducerToken();
+		moodycamel::ConsumerToken* GetConsumerToken();
+#elif USE_BOUNDED_RING_QUEUE && !USE_MS_CONCURRENT_QUEUE && !USE_INTRUSIVE_TASK_QUEUE
+		bool DequeueOverflowTask(H1TaskDeclaration*& pTask);
+#endif
+
 		// task queue priority
 		ETaskQueuePriority m_Priority;
 		// task concurrent queue consumed by H1FiberContext
 #if USE_MS_CONCURRENT_QUEUE
 		concurrency::concurrent_queue<H1TaskDeclaration*> m_QueuedTasks;
+#elif USE_INTRUSIVE_TASK_QUEUE
+		H1IntrusiveTaskQueue m_QueuedTasks;
+#elif USE_BOUNDED_RING_QUEUE
+		// the tasks spill to the overflow list while the ring is full (enqueue never waits for the consumers)
+		//	- the overflow is intrusive (linked through the declarations), so the mode doesn't allocate or depend on moodycamel
+		//	- while the overflow is not empty, new tasks join it behind the spilled ones; the ring drains first and nothing starves (FIFO)
+		//	- the ring cells are cache-line sized, so the ring is kept small; the overflow absorbs the bursts
+		static const uint32_t BoundedQueueCapacity = (1 << 12);
+		H1BoundedQueue<H1TaskDeclaration*> m_QueuedTasks;
+		H1IntrusiveTaskQueue m_OverflowTasks;
+		// the number of the tasks in the overflow (increased before they are linked, so it never goes below zero)
+		std::atomic<int32_t> m_OverflowCounts;
 #else
 		moodycamel::ConcurrentQueue<H1TaskDeclaration*> m_QueuedTasks;
+		// tokens of worker threads (indexed by worker thread index)
+		std::vector<moodycamel::ProducerToken*> m_ProducerTokens;
+		std::vector<moodycamel::ConsumerToken*> m_ConsumerTokens;
 #endif
 	};
 }
\ No newline at end of file
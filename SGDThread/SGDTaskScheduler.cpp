@@ -23,14 +23,16 @@
 
 #include "SGDThreadPCH.h"
 #include "SGDTaskScheduler.h"
+#include <algorithm>
 using namespace SGD;
 
 SGD::H1TaskScheduler* SGD::H1TaskSchedulerLayer::gTaskScheduler = nullptr;
 
 H1TaskScheduler::H1TaskScheduler()
-	: m_WaitFiberContextQueue(this)
-	, m_MainThread(nullptr)
+	: m_MainThread(nullptr)
 	, m_MainThreadId(-1)
+	, m_DeadlineTaskRoundRobin(0)
+	, m_TaskDequeueBatchSize(DefaultTaskDequeueBatchSize)
 {
 	// setting nullptr for task queues
 	for (uint32_t i = 0; i < ETaskQueuePriority::ETQP_Max; ++i)
@@ -60,28 +62,43 @@ bool H1TaskScheduler::Initialize()
 	if (!m_WorkerThreadPool.Initialize(this))
 		return false;
 
-	// initialize wait-fiber-context queue
-	if (!m_WaitFiberContextQueue.Initialize())
+	// initialize task queues (with the tokens for each worker thread)
+	uint32_t workerThreadCounts = m_WorkerThreadPool.GetWorkerThreadCounts();
+	m_TaskQueues[ETaskQueuePriority::ETQP_High] = new H1TaskQueue(ETaskQueuePriority::ETQP_High, workerThreadCounts);
+	m_TaskQueues[ETaskQueuePriority::ETQP_Mid] = new H1TaskQueue(ETaskQueuePriority::ETQP_Mid, workerThreadCounts);
+	m_TaskQueues[ETaskQueuePriority::ETQP_Low] = new H1TaskQueue(ETaskQueuePriority::ETQP_Low, workerThreadCounts);
+
+	// initialize task declaration pool
+	if (!m_TaskDeclarationPool.Initialize(workerThreadCounts))
+		return false;
+
+	// initialize offload thread pool (the threads are spawned on demand)
+	if (!m_OffloadPool.Initialize())
 		return false;
 
-	// initialize task queues
-	m_TaskQueues[ETaskQueuePriority::ETQP_High] = new H1TaskQueue(ETaskQueuePriority::ETQP_High);
-	m_TaskQueues[ETaskQueuePriority::ETQP_Mid] = new H1TaskQueue(ETaskQueuePriority::ETQP_Mid);
-	m_TaskQueues[ETaskQueuePriority::ETQP_Low] = new H1TaskQueue(ETaskQueuePriority::ETQP_Low);
+	// initialize I/O reactor
+	if (!m_Reactor.Initialize())
+		return false;
 
 	return true;
 }
 
 void H1TaskScheduler::Destroy()
 {
+	// destroy offload thread pool (it waits for the running blocking calls)
+	m_OffloadPool.Destroy();
+
+	// destroy I/O reactor
+	m_Reactor.Destroy();
+
 	// destroy fiber context pool
 	m_FiberContextPool.Destroy();
 
 	// destroy worker thread pool
 	m_WorkerThreadPool.Destroy();
 
-	// destroy wait-fiber-context queue
-	m_WaitFiberContextQueue.Destroy();
+	// destroy task declaration pool
+	m_TaskDeclarationPool.Destroy();
 
 	// deallocate task queue
 	for (uint32_t i = 0; i < ETaskQueuePriority::ETQP_Max; ++i)
@@ -93,8 +110,150 @@ void H1TaskScheduler::Destroy()
 
 H1WorkerThread* H1TaskScheduler::GetCurrentThread()
 {	
-	ThreadId currThreadId = appGetCurrentThreadId();
-	return m_WorkerThreadPool.GetWorkerThreadById(currThreadId);
+	// thread-local lookup (no thread id scan over the worker threads); it is on the path of every fiber-local access and cancellation poll
+	return H1WorkerThread::GetCurrentWorkerThread();
+}
+
+bool H1TaskScheduler::EnqueueTask(H1TaskDeclaration* pTask, ETaskQueuePriority tqPriority)
+{
+	pTask->SetQueuePriority(static_cast<uint8_t>(tqPriority));
+	if (!pTask->HasDeadline())
+		return m_TaskQueues[tqPriority]->EnqueueTask(pTask);
+
+	// distribute deadline tasks to worker threads in round-robin
+	uint32_t workerThreadCounts = m_WorkerThreadPool.GetWorkerThreadCounts();
+	uint32_t workerThreadIndex = m_DeadlineTaskRoundRobin.fetch_add(1, std::memory_order_relaxed) % workerThreadCounts;
+	return m_WorkerThreadPool.GetWorkerThreadByIndex(workerThreadIndex)->GetDeadlineTaskQueue().EnqueueTask(pTask);
+}
+
+bool H1TaskScheduler::EnqueueTaskRange(H1TaskDeclaration* tasks, int32_t taskCounts, ETaskQueuePriority tqPriority)
+{
+	bool bHasDeadlineTask = false;
+	for (int32_t taskIdx = 0; taskIdx < taskCounts; ++taskIdx)
+	{
+		tasks[taskIdx].SetQueuePriority(static_cast<uint8_t>(tqPriority));
+		bHasDeadlineTask = bHasDeadlineTask || tasks[taskIdx].HasDeadline();
+	}
+
+	// tasks without the deadline are enqueued at once
+	if (!bHasDeadlineTask)
+		return m_TaskQueues[tqPriority]->EnqueueTaskRange(tasks, taskCounts);
+
+	for (int32_t taskIdx = 0; taskIdx < taskCounts; ++taskIdx)
+	{
+		if (!EnqueueTask(&tasks[taskIdx], tqPriority))
+			return false;
+	}
+	return true;
+}
+
+H1TaskDeclaration* H1TaskScheduler::DequeueTask(H1WorkerThread* pWorkerThread)
+{
+	// 1) the earliest deadline task of this worker thread
+	H1TaskDeclaration* pTask = pWorkerThread->GetDeadlineTaskQueue().DequeueTask();
+	if (pTask != nullptr)
+		return pTask;
+
+	// 2) tasks already dequeued in batch
+	//	- the queues with higher priority than the buffered tasks are checked first; new high-priority task doesn't wait behind them
+	H1LocalTaskBuffer& rLocalTaskBuffer = pWorkerThread->GetLocalTaskBuffer();
+	if (!rLocalTaskBuffer.IsEmpty())
+	{
+		for (uint32_t i = 0; i < static_cast<uint32_t>(rLocalTaskBuffer.GetPriority()); ++i)
+		{
+			pTask = m_TaskQueues[i]->DequeueTask();
+			if (pTask != nullptr)
+				return pTask;
+		}
+		// the thieves could take the rest meanwhile
+		pTask = rLocalTaskBuffer.Pop();
+		if (pTask != nullptr)
+			return pTask;
+	}
+
+	// 3) priority queues in FIFO order (high -> mid -> low)
+	//	- grab small batch with one bulk dequeue to amortize the synchronization of the queue
+	//	- the batch comes only from the highest non-empty queue; the first task runs now and the rest are buffered
+	int32_t batchSize = m_TaskDequeueBatchSize.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < ETaskQueuePriority::ETQP_Max; ++i)
+	{
+		if (batchSize <= 1)
+		{
+			pTask = m_TaskQueues[i]->DequeueTask();
+			if (pTask != nullptr)
+				return pTask;
+			continue;
+		}
+
+		H1TaskDeclaration* batchTasks[H1LocalTaskBuffer::Capacity];
+		int32_t dequeuedCounts = m_TaskQueues[i]->DequeueTaskBulk(batchTasks, batchSize);
+		if (dequeuedCounts > 0)
+		{
+			rLocalTaskBuffer.Refill(batchTasks + 1, dequeuedCounts - 1, static_cast<ETaskQueuePriority>(i));
+			return batchTasks[0];
+		}
+	}
+
+	// 4) steal the buffered tasks of other worker threads (the owner could be busy with a long-running task)
+	//	- start from the next worker thread, so thieves don't gather on the first worker thread
+	uint32_t workerThreadCounts = m_WorkerThreadPool.GetWorkerThreadCounts();
+	uint32_t startIndex = static_cast<uint32_t>(pWorkerThread->GetWorkerThreadIndex()) + 1;
+	for (uint32_t i = 0; i + 1 < workerThreadCounts; ++i)
+	{
+		H1LocalTaskBuffer& rOtherLocalTaskBuffer = m_WorkerThreadPool.GetWorkerThreadByIndex((startIndex + i) % workerThreadCounts)->GetLocalTaskBuffer();
+		if (rOtherLocalTaskBuffer.IsEmpty())
+			continue;
+		pTask = rOtherLocalTaskBuffer.Pop();
+		if (pTask != nullptr)
+			return pTask;
+	}
+
+	// 5) steal deadline task from other worker threads which are busy
+	for (uint32_t i = 0; i < workerThreadCounts; ++i)
+	{
+		H1WorkerThread* pOtherWorkerThread = m_WorkerThreadPool.GetWorkerThreadByIndex(i);
+		if (pOtherWorkerThread == pWorkerThread)
+			continue;
+		pTask = pOtherWorkerThread->GetDeadlineTaskQueue().StealTask();
+		if (pTask != nullptr)
+			return pTask;
+	}
+
+	return nullptr;
+}
+
+H1FiberContext* H1TaskScheduler::StealReadyFiberContext(H1WorkerThread* pWorkerThread)
+{
+	// start from the next worker thread, so thieves don't gather on the first worker thread
+	uint32_t workerThreadCounts = m_WorkerThreadPool.GetWorkerThreadCounts();
+	uint32_t startIndex = static_cast<uint32_t>(pWorkerThread->GetWorkerThreadIndex()) + 1;
+	for (uint32_t i = 0; i < workerThreadCounts - 1; ++i)
+	{
+		H1WorkerThread* pOtherWorkerThread = m_WorkerThreadPool.GetWorkerThreadByIndex((startIndex + i) % workerThreadCounts);
+		H1ReadyFiberContextQueue& rReadyFiberContextQueue = pOtherWorkerThread->GetReadyFiberContextQueue();
+		if (rReadyFiberContextQueue.IsEmpty())
+			continue;
+		H1FiberContext* pFiberContext = rReadyFiberContextQueue.Dequeue();
+		if (pFiberContext != nullptr)
+			return pFiberContext;
+	}
+	return nullptr;
+}
+
+void H1TaskScheduler::SetTaskDequeueBatchSize(int32_t batchSize)
+{
+	const int32_t maxBatchSize = H1LocalTaskBuffer::Capacity;
+	m_TaskDequeueBatchSize.store(std::max(1, std::min(batchSize, maxBatchSize)), std::memory_order_relaxed);
+}
+
+void H1TaskSchedulerLayer::RunBlockingCall(OffloadEntryPoint entryPoint, void* data)
+{
+	GetTaskScheduler()->GetOffloadPool().Run(entryPoint, data);
+}
+
+uint64_t H1TaskSchedulerLayer::GetDeadlineAfter(uint32_t microseconds)
+{
+	return appGetTimestamp() + (appGetTimestampFrequency() * microseconds) / 1000000ull;
 }
 
 H1TaskScheduler* H1TaskSchedulerLayer::GetTaskScheduler()
@@ -116,6 +275,18 @@ void H1TaskSchedulerLayer::DestroyTaskScheduler()
 }
 
 bool H1TaskSchedulerLayer::RunTasks(H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter** ppTaskCounter)
+{
+	if (!BindTasks(tasks, taskCounts, ppTaskCounter))
+		return false;
+
+	// add tasks to task queue
+	// @TODO - temporary enqueue into high-priority queue
+	GetTaskScheduler()->EnqueueTaskRange(tasks, taskCounts, ETQP_High);
+
+	return true;
+}
+
+bool H1TaskSchedulerLayer::BindTasks(H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter** ppTaskCounter)
 {
 	H1TaskScheduler* pTaskScheduler = GetTaskScheduler();
 	if (pTaskScheduler == nullptr)
@@ -137,8 +308,6 @@ bool H1TaskSchedulerLayer::RunTasks(H1TaskDeclaration* tasks, int32_t taskCounts
 			tasks[i].SetParent(nullptr);
 		}
 
-		pTaskScheduler->GetTaskQueue(ETQP_High)->EnqueueTaskRange(tasks, taskCounts);
-
 		return true;
 	}
 
@@ -164,13 +333,18 @@ bool H1TaskSchedulerLayer::RunTasks(H1TaskDeclaration* tasks, int32_t taskCounts
 		tasks[i].SetParent(currFiberContext->GetTaskSlot());
 	}
 
-	// add tasks to task queue
-	// @TODO - temporary enqueue into high-priority queue
-	pTaskScheduler->GetTaskQueue(ETQP_High)->EnqueueTaskRange(tasks, taskCounts);
-
 	return true;
 }
 
+// park callback for WaitForCounter
+static bool ParkFiberContextOnTaskCounter(H1FiberContext* pFiberContext, void* pData)
+{
+	// the counter could reach zero before the waiting fiber context is published; resume immediately
+	//	- after it is published, don't touch the counter (the releaser could resume the fiber destroying it)
+	H1TaskCounter* pTaskCounter = reinterpret_cast<H1TaskCounter*>(pData);
+	return pTaskCounter->SetWaitingFiberContext(pFiberContext);
+}
+
 bool H1TaskSchedulerLayer::WaitForCounter(H1TaskCounter* pTaskCounter, H1TaskCounter::TaskCounterType value)
 {
 	// @TODO - currently, there is no functionality for matching certain value option (just handling only value == zero)
@@ -187,22 +361,229 @@ bool H1TaskSchedulerLayer::WaitForCounter(H1TaskCounter* pTaskCounter, H1TaskCou
 	}
 
 	if (pTaskCounter->Get() == value)
-		return false; // invalid counter is inserted
+		return true; // already reached
 		
-	// move current fiber context to wait queue
+	// park current fiber context until the counter reaches zero
+	//	- the fiber is resumed by the task releasing the counter (H1TaskCounter::Release)
+	return SuspendCurrentFiber(ParkFiberContextOnTaskCounter, pTaskCounter);
+}
+
+// park data for SleepUntil (on the stack of the sleeping fiber)
+struct H1SleepParkData
+{
+	H1TimerNode* TimerNode;
+	uint64_t ExpireTimestamp;
+};
+
+// timer callback resuming the sleeping fiber
+static void ResumeSleepingFiberContext(void* pData)
+{
+	H1TaskSchedulerLayer::ResumeFiber(reinterpret_cast<H1FiberContext*>(pData));
+}
+
+// park callback for SleepUntil
+static bool ParkFiberContextOnTimer(H1FiberContext* pFiberContext, void* pData)
+{
+	H1SleepParkData* pSleepParkData = reinterpret_cast<H1SleepParkData*>(pData);
+	if (appGetTimestamp() >= pSleepParkData->ExpireTimestamp)
+		return false; // already expired; resume immediately
+
+	// the timer wheel of the worker thread parking the fiber; the worker advances it in its loop and resumes the fiber there
+	pSleepParkData->TimerNode->Data = pFiberContext;
+	pFiberContext->GetOwner()->GetTimerWheel().Insert(pSleepParkData->TimerNode, pSleepParkData->ExpireTimestamp);
+	return true;
+}
+
+void H1TaskSchedulerLayer::SleepFor(uint32_t microseconds)
+{
+	SleepUntil(GetDeadlineAfter(microseconds));
+}
+
+void H1TaskSchedulerLayer::SleepUntil(uint64_t timestamp)
+{
+	if (appGetTimestamp() >= timestamp)
+		return;
+
+	// suspend the fiber without blocking the worker thread
+	H1TimerNode timerNode(ResumeSleepingFiberContext);
+	H1SleepParkData sleepParkData = { &timerNode, timestamp };
+	if (SuspendCurrentFiber(ParkFiberContextOnTimer, &sleepParkData))
+		return;
+
+	// not the fiber (e.g. main thread); block the thread for the coarse part and spin for the rest
+	const uint64_t spinTimestamps = GetDeadlineAfter(2000) - appGetTimestamp();
+	uint64_t currTimestamp = appGetTimestamp();
+	while (currTimestamp < timestamp)
+	{
+		uint64_t remainTimestamps = timestamp - currTimestamp;
+		if (remainTimestamps > spinTimestamps)
+			appSleep(uint32_t(((remainTimestamps - spinTimestamps) * 1000ull) / appGetTimestampFrequency()));
+		else
+			appYieldProcessor();
+		currTimestamp = appGetTimestamp();
+	}
+}
+
+bool H1TaskSchedulerLayer::RunTasksWithCounter(H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter* pTaskCounter)
+{
+	H1TaskScheduler* pTaskScheduler = GetTaskScheduler();
+	if (pTaskScheduler == nullptr)
+		return false; // error for creating task scheduler
+
+	// parent is current task slot (null in main thread)
+	H1FiberContext* currFiberContext = GetCurrentFiberContext();
+	H1TaskDeclaration* parentTask = currFiberContext != nullptr ? currFiberContext->GetTaskSlot() : nullptr;
+
+	pTaskCounter->FetchAndAdd(taskCounts);
+	for (int32_t i = 0; i < taskCounts; ++i)
+	{
+		tasks[i].SetTaskCounter(pTaskCounter);
+		tasks[i].SetParent(parentTask);
+	}
+
+	// @TODO - temporary enqueue into high-priority queue
+	pTaskScheduler->EnqueueTaskRange(tasks, taskCounts, ETQP_High);
+
+	return true;
+}
+
+bool H1TaskSchedulerLayer::SuspendCurrentFiber(FiberContextParkCallback callback, void* data)
+{
+	H1TaskScheduler* pTaskScheduler = GetTaskScheduler();
+	if (pTaskScheduler == nullptr)
+		return false; // error for creating task scheduler
+
 	H1WorkerThread* currWorkerThread = pTaskScheduler->GetCurrentThread();
-	H1FiberContext* bindedFiberContext = currWorkerThread->GetCurrentBindedFiberContext();
-	if (bindedFiberContext == nullptr)
+	if (currWorkerThread == nullptr)
+		return false; // not worker thread (e.g. main thread)
+
+	if (currWorkerThread->GetCurrentBindedFiberContext() == nullptr)
 		return false; // no binded fiber context exists!
 
-	if (!pTaskScheduler->GetWaitFiberContextQueue().Enqueue(bindedFiberContext->GetFiberId(), bindedFiberContext->GetFiberType()))
+	// switch to thread-fiber; when it returns, the fiber is resumed (possibly in other worker thread)
+	currWorkerThread->ParkFiberContext(callback, data);
+
+	return true;
+}
+
+void H1TaskSchedulerLayer::ResumeFiber(H1FiberContext* pFiberContext)
+{
+	// the owner is kept while the fiber is suspended; resume it where its stack is likely still in the cache
+	H1WorkerThread* pWorkerThread = pFiberContext->GetOwner();
+	if (pWorkerThread == nullptr)
+		pWorkerThread = GetTaskScheduler()->GetWorkerThreadPool().GetFirstThread();
+	pWorkerThread->GetReadyFiberContextQueue().Enqueue(pFiberContext);
+}
+
+H1FiberContext* H1TaskSchedulerLayer::GetCurrentFiberContext()
+{
+	H1TaskScheduler* pTaskScheduler = GetTaskScheduler();
+	if (pTaskScheduler == nullptr)
+		return nullptr;
+
+	H1WorkerThread* currWorkerThread = pTaskScheduler->GetCurrentThread();
+	if (currWorkerThread == nullptr)
+		return nullptr; // not worker thread (e.g. main thread)
+
+	return currWorkerThread->GetCurrentBindedFiberContext();
+}
+
+bool H1TaskSchedulerLayer::SpawnTask(TaskEntryPoint taskBody, void* taskData, H1TaskCounter* pTaskCounter, ETaskQueuePriority tqPriority)
+{
+	H1TaskScheduler* pTaskScheduler = GetTaskScheduler();
+	if (pTaskScheduler == nullptr)
+		return false;
+
+	H1TaskDeclaration* pTask = pTaskScheduler->GetTaskDeclarationPool().Acquire();
+	pTask->SetTaskEntryPoint(taskBody);
+	pTask->SetTaskData(taskData);
+	// the cancellation token of the caller is not inherited; the detached task could outlive the caller and its token
+	if (pTaskCounter != nullptr)
+	{
+		pTaskCounter->FetchAndAdd(1);
+		pTask->SetTaskCounter(pTaskCounter);
+	}
+
+	return pTaskScheduler->EnqueueTask(pTask, tqPriority);
+}
+
+H1ScratchArena* H1TaskSchedulerLayer::GetCurrentScratchArena()
+{
+	H1FiberContext* currFiberContext = GetCurrentFiberContext();
+	if (currFiberContext == nullptr)
+		return nullptr;
+	return currFiberContext->GetScratchArena();
+}
+
+FiberLocalSlot H1TaskSchedulerLayer::AllocateFiberLocalSlot(FiberLocalCleanup cleanup)
+{
+	return H1FiberContext::AllocateLocalSlot(cleanup);
+}
+
+void H1TaskSchedulerLayer::FreeFiberLocalSlot(FiberLocalSlot slot)
+{
+	H1FiberContext::FreeLocalSlot(slot);
+}
+
+void* H1TaskSchedulerLayer::GetFiberLocalValue(FiberLocalSlot slot)
+{
+	H1FiberContext* currFiberContext = GetCurrentFiberContext();
+	if (currFiberContext == nullptr)
+		return nullptr;
+	return currFiberContext->GetLocalValue(slot);
+}
+
+bool H1TaskSchedulerLayer::SetFiberLocalValue(FiberLocalSlot slot, void* value)
+{
+	H1FiberContext* currFiberContext = GetCurrentFiberContext();
+	if (currFiberContext == nullptr)
 		return false;
+	currFiberContext->SetLocalValue(slot, value);
+	return true;
+}
 
-	// switch to thread-fiber
-	currWorkerThread->SwitchThreadFiberContext();
+bool H1TaskSchedulerLayer::IsCurrentTaskCancelled()
+{
+	// nothing is cancelled (common case); one load without looking up current task
+	if (!H1TaskCancellationToken::IsAnyCancelled())
+		return false;
+
+	H1TaskCancellationToken* pCancellationToken = GetCurrentCancellationToken();
+	return pCancellationToken != nullptr && pCancellationToken->IsCancelled();
+}
+
+H1TaskCancellationToken* H1TaskSchedulerLayer::GetCurrentCancellationToken()
+{
+	H1FiberContext* currFiberContext = GetCurrentFiberContext();
+	if (currFiberContext == nullptr || currFiberContext->GetTaskSlot() == nullptr)
+		return nullptr;
+	return currFiberContext->GetTaskSlot()->GetCancellationToken();
+}
+
+bool H1TaskSchedulerLayer::RunTasksAfter(H1TaskCounter* pDependency, H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter* pContinuationCounter)
+{
+	if (GetTaskScheduler() == nullptr)
+		return false; // error for creating task scheduler
+	if (pDependency == nullptr || taskCounts <= 0)
+		return false;
+
+	if (pContinuationCounter != nullptr)
+		pContinuationCounter->FetchAndAdd(taskCounts);
+
+	// link continuations; they have no parent fiber to resume, but inherit the cancellation of the caller
+	H1TaskCancellationToken* pCancellationToken = GetCurrentCancellationToken();
+	for (int32_t i = 0; i < taskCounts; ++i)
+	{
+		tasks[i].SetTaskCounter(pContinuationCounter);
+		tasks[i].SetParent(nullptr);
+		tasks[i].SetInheritedCancellationToken(pCancellationToken);
+		tasks[i].SetNext(i + 1 < taskCounts ? &tasks[i + 1] : nullptr);
+	}
 
-	// wait until task counter reach to the value
-	while (pTaskCounter->Get() != value) {}	
+	// the dependency could already reach zero before continuations are added; release them by ourselves
+	//	- NOTE THAT - once they are added, don't touch the dependency (e.g. the resumed coroutine could destroy the counter in its frame)
+	if (!pDependency->AddContinuations(&tasks[0], &tasks[taskCounts - 1]))
+		H1TaskCounter::ReleaseContinuations(&tasks[0]);
 
 	return true;
 }
\ No newline at end of file
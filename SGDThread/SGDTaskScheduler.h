@@ -26,7 +26,11 @@
 #include "SGDFiberContext.h"
 #include "SGDWorkerThread.h"
 #include "SGDTaskQueue.h"
-#include "SGDWaitFiberContextQueue.h"
+#include "SGDDeadlineTaskQueue.h"
+#include "SGDTaskDeclarationPool.h"
+#include "SGDOffloadPool.h"
+#include "SGDReactor.h"
+#include "SGDAsyncFile.h"
 
 namespace SGD
 {
@@ -39,6 +43,7 @@ namespace SGD
 		bool Initialize();
 		void Destroy();
 
+		// null in the thread which is not the worker thread (e.g. main thread)
 		H1WorkerThread* GetCurrentThread();
 
 		inline ThreadId GetMainThreadId() { return m_MainThreadId; }
@@ -46,21 +51,49 @@ namespace SGD
 
 		inline H1WorkerThreadPool& GetWorkerThreadPool() { return m_WorkerThreadPool;}
 		inline H1FiberContextPool& GetFiberContextPool() { return m_FiberContextPool; }
-		inline H1WaitFiberContextQueue& GetWaitFiberContextQueue() { return m_WaitFiberContextQueue; }
 		inline H1TaskQueue* GetTaskQueue(ETaskQueuePriority tqPriority) { return m_TaskQueues[tqPriority]; }
+		inline H1DeadlineMetrics& GetDeadlineMetrics() { return m_DeadlineMetrics; }
+		inline H1TaskDeclarationPool& GetTaskDeclarationPool() { return m_TaskDeclarationPool; }
+		inline H1OffloadPool& GetOffloadPool() { return m_OffloadPool; }
+		inline H1Reactor& GetReactor() { return m_Reactor; }
+		inline H1AsyncFileIO& GetAsyncFileIO() { return m_AsyncFileIO; }
+
+		// enqueue the task into the priority queue, or the deadline task queue of a worker thread when it has the deadline
+		bool EnqueueTask(H1TaskDeclaration* pTask, ETaskQueuePriority tqPriority);
+		bool EnqueueTaskRange(H1TaskDeclaration* tasks, int32_t taskCounts, ETaskQueuePriority tqPriority);
+		// pick next task for the worker thread: earliest deadline first, then priority queues (FIFO)
+		H1TaskDeclaration* DequeueTask(H1WorkerThread* pWorkerThread);
+		// take the fiber context ready in other worker threads (for idle worker thread)
+		H1FiberContext* StealReadyFiberContext(H1WorkerThread* pWorkerThread);
+
+		// the number of tasks dequeued at once into the worker-local buffer (1 means one-at-a-time)
+		//	- the buffered tasks are stolen by the idle worker threads (see H1LocalTaskBuffer)
+		static const int32_t DefaultTaskDequeueBatchSize = 8;
+		void SetTaskDequeueBatchSize(int32_t batchSize);
+		inline int32_t GetTaskDequeueBatchSize() const { return m_TaskDequeueBatchSize.load(std::memory_order_relaxed); }
 
 	private:
 		// fiber context pool
 		H1FiberContextPool m_FiberContextPool;
 		// worker thread pool
 		H1WorkerThreadPool m_WorkerThreadPool;
-		// wait fiber context queue
-		// @TODO - need to think about the design for concurrent wait fiber context queue
-		//	- there are big problems to make it concurrent container with wait-queue
-		H1WaitFiberContextQueue m_WaitFiberContextQueue;
 		// task queues (high, mid, low) - concurrent task queue
 		//	- multiple threads access these queues
 		H1TaskQueue* m_TaskQueues[ETaskQueuePriority::ETQP_Max];
+		// round-robin index distributing deadline tasks to worker threads
+		std::atomic<uint32_t> m_DeadlineTaskRoundRobin;
+		// batch size of dequeue from the priority queues
+		std::atomic<int32_t> m_TaskDequeueBatchSize;
+		// per-frame deadline misses
+		H1DeadlineMetrics m_DeadlineMetrics;
+		// declarations for fire-and-forget tasks
+		H1TaskDeclarationPool m_TaskDeclarationPool;
+		// OS threads running blocking calls for the fibers
+		H1OffloadPool m_OffloadPool;
+		// I/O readiness of the descriptors polled by idle worker threads
+		H1Reactor m_Reactor;
+		// file I/O rings of the worker threads
+		H1AsyncFileIO m_AsyncFileIO;
 		// main thread
 		ThreadType m_MainThread;
 		ThreadId m_MainThreadId;
@@ -81,7 +114,57 @@ namespace SGD
 
 		// public methods (utility functions) used for TaskScheduler(fiber-based)
 		static bool RunTasks(H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter** ppTaskCounter);
+		// bind task counter and parent of the tasks like RunTasks, but leave enqueueing to the caller (e.g. H1TaskGraph)
+		static bool BindTasks(H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter** ppTaskCounter);
 		static bool WaitForCounter(H1TaskCounter* pTaskCounter, H1TaskCounter::TaskCounterType value = 0);
+		// bind the tasks to the given counter (instead of the counter of current fiber context) and enqueue them
+		static bool RunTasksWithCounter(H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter* pTaskCounter);
+		// run tasks as continuations when pDependency reaches zero (or right now if it is already zero), without parking a fiber
+		//	- pDependency could be the counter returned by RunTasks to continue the batch
+		//	- pContinuationCounter (optional) is incremented by taskCounts and decremented as each continuation finishes
+		//	- the caller owns tasks until they finish (same as RunTasks)
+		static bool RunTasksAfter(H1TaskCounter* pDependency, H1TaskDeclaration* tasks, int32_t taskCounts, H1TaskCounter* pContinuationCounter = nullptr);
+		// fire-and-forget task with the declaration from the pool (recycled automatically after it finishes)
+		//	- the caller doesn't need to wait for the task; the task has no parent and doesn't inherit the cancellation of the caller
+		//	  (the token could be destroyed before the task runs); pass the token through taskData when it outlives the task
+		//	- pTaskCounter (optional) is incremented and decremented as the task finishes
+		static bool SpawnTask(TaskEntryPoint taskBody, void* taskData, H1TaskCounter* pTaskCounter = nullptr, ETaskQueuePriority tqPriority = ETQP_High);
+
+		// suspend current fiber; the callback publishes the fiber to be resumed (see FiberContextParkCallback)
+		//	- return false when it is not called in the fiber context (e.g. main thread)
+		static bool SuspendCurrentFiber(FiberContextParkCallback callback, void* data);
+		// move the suspended fiber to ready-to-resume queue of the worker thread which ran it last
+		static void ResumeFiber(H1FiberContext* pFiberContext);
+		// current binded fiber context (null in main thread or thread fiber context)
+		static H1FiberContext* GetCurrentFiberContext();
+
+		// scratch arena of current fiber context (null in main thread)
+		static H1ScratchArena* GetCurrentScratchArena();
+
+		// fiber-local storage of current fiber context (see H1FiberContext::AllocateLocalSlot)
+		//	- the main thread has no fiber context; get returns null and set returns false
+		static FiberLocalSlot AllocateFiberLocalSlot(FiberLocalCleanup cleanup = nullptr);
+		static void FreeFiberLocalSlot(FiberLocalSlot slot);
+		static void* GetFiberLocalValue(FiberLocalSlot slot);
+		static bool SetFiberLocalValue(FiberLocalSlot slot, void* value);
+
+		// run the blocking call (e.g. file I/O) in the offload thread pool, suspending current fiber until it completes
+		static void RunBlockingCall(OffloadEntryPoint entryPoint, void* data);
+
+		// deadline timestamp after the given time from now (see H1TaskDeclaration::SetDeadline)
+		static uint64_t GetDeadlineAfter(uint32_t microseconds);
+
+		// suspend current fiber for the time without blocking the worker thread (see H1TimerWheel)
+		//	- the fiber is resumed by the worker thread parking it when it advances its timer wheel (the accuracy is about one tick)
+		//	- the caller which is not the fiber (e.g. main thread) blocks its thread instead
+		static void SleepFor(uint32_t microseconds);
+		// timestamp by appGetTimestamp
+		static void SleepUntil(uint64_t timestamp);
+
+		// cancellation of current running task (polled by long running task-body)
+		static bool IsCurrentTaskCancelled();
+		// use it as parent to create the token cancelling sub-tree of current task
+		static H1TaskCancellationToken* GetCurrentCancellationToken();
 
 	private:
 		static H1TaskScheduler* gTaskScheduler;
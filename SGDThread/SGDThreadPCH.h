@@ -26,8 +26,12 @@
 #include <thread>
 #include <atomic>
 #include <vector>
+#include <new>
+#include <type_traits>
 
 #if WIN32
+// winsock2 should precede Windows.h (it is used by H1Reactor)
+#include <winsock2.h>
 #include <Windows.h>
 #endif
 
@@ -58,3 +62,16 @@
 #if USE_MS_CONCURRENT_QUEUE
 #include "concurrent_queue.h"
 #endif
+
+// intrusive lock-free task queue (the link lives in H1TaskDeclaration, no allocation) for H1TaskQueue
+#define USE_INTRUSIVE_TASK_QUEUE 0
+
+// bounded ring queue (H1BoundedQueue) for H1TaskQueue and free lists of H1FiberContextPool
+#define USE_BOUNDED_RING_QUEUE 0
+
+// stackless coroutine tasks (C++20 coroutines or MSVC '/await')
+#if defined(__cpp_impl_coroutine) || defined(_RESUMABLE_FUNCTIONS_SUPPORTED)
+#define SGD_COROUTINE_SUPPORT 1
+#else
+#define SGD_COROUTINE_SUPPORT 0
+#endif
\ No newline at end of file
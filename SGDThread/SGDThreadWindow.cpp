@@ -86,6 +86,56 @@ namespace SGD
 		SetThreadAffinityMask(GetCurrentThread(), coreAffinity);
 	}
 
+	// reserve and commit page-aligned memory directly from OS (bypass process heap)
+	inline void* appAllocateVirtualMemory(size_t size)
+	{
+		return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+
+	inline void appFreeVirtualMemory(void* address)
+	{
+		VirtualFree(address, 0, MEM_RELEASE);
+	}
+
+	// heap memory aligned to the cache line (e.g. array of the padded slots); operator new doesn't over-align before C++17
+	inline void* appAllocateAlignedMemory(size_t size, size_t alignment)
+	{
+		return _aligned_malloc(size, alignment);
+	}
+
+	inline void appFreeAlignedMemory(void* address)
+	{
+		_aligned_free(address);
+	}
+
+	// hint to the processor in the spin-wait loop
+	inline void appYieldProcessor()
+	{
+		YieldProcessor();
+	}
+
+	// block the calling thread
+	inline void appSleep(uint32_t milliseconds)
+	{
+		Sleep(milliseconds);
+	}
+
+	// high-resolution timestamp in ticks
+	inline uint64_t appGetTimestamp()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return static_cast<uint64_t>(counter.QuadPart);
+	}
+
+	// ticks per second of appGetTimestamp
+	inline uint64_t appGetTimestampFrequency()
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return static_cast<uint64_t>(frequency.QuadPart);
+	}
+
 	inline void appCreateEvent(EventType* event)
 	{
 		event->Event = CreateEvent(nullptr, TRUE, FALSE, nullptr);
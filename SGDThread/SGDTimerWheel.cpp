@@ -0,0 +1,209 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "SGDThreadPCH.h"
+#include "SGDTimerWheel.h"
+using namespace SGD;
+
+H1TimerWheel::H1TimerWheel()
+	: m_TickTimestamps(1)
+	, m_CurrentTick(0)
+	, m_TimerCounts(0)
+	, m_bLocked(false)
+{
+	memset(m_Slots, 0, sizeof(m_Slots));
+}
+
+H1TimerWheel::~H1TimerWheel()
+{
+
+}
+
+bool H1TimerWheel::Initialize(uint32_t tickMicroseconds)
+{
+	m_TickTimestamps = (appGetTimestampFrequency() * tickMicroseconds) / 1000000ull;
+	if (m_TickTimestamps == 0)
+		m_TickTimestamps = 1;
+	m_CurrentTick = appGetTimestamp() / m_TickTimestamps;
+	return true;
+}
+
+void H1TimerWheel::Destroy()
+{
+	// the remaining nodes are owned by others; just forget them
+	memset(m_Slots, 0, sizeof(m_Slots));
+	m_TimerCounts.store(0, std::memory_order_relaxed);
+}
+
+void H1TimerWheel::Lock()
+{
+	while (m_bLocked.exchange(true, std::memory_order_acquire))
+	{
+		while (m_bLocked.load(std::memory_order_relaxed))
+			appYieldProcessor();
+	}
+}
+
+void H1TimerWheel::Unlock()
+{
+	m_bLocked.store(false, std::memory_order_release);
+}
+
+void H1TimerWheel::Insert(H1TimerNode* pNode, uint64_t expireTimestamp)
+{
+	assert(pNode->SlotHead == nullptr && "[invalid] the timer node is already scheduled");
+
+	// round up; the timer never expires earlier than the timestamp
+	pNode->ExpireTick = (expireTimestamp + m_TickTimestamps - 1) / m_TickTimestamps;
+
+	// the counts are updated with the lock held; Advance jumps over the ticks only when it sees no timer
+	Lock();
+	if (m_TimerCounts.load(std::memory_order_relaxed) == 0)
+	{
+		// the worker doesn't advance the empty wheel; catch up the idle gap here, so the next advance doesn't walk it tick by tick
+		uint64_t currentTick = appGetTimestamp() / m_TickTimestamps;
+		if (currentTick > m_CurrentTick)
+			m_CurrentTick = currentTick;
+	}
+	Link(pNode, m_CurrentTick + 1);
+	m_TimerCounts.fetch_add(1, std::memory_order_relaxed);
+	Unlock();
+}
+
+bool H1TimerWheel::Cancel(H1TimerNode* pNode)
+{
+	Lock();
+	if (pNode->SlotHead == nullptr)
+	{
+		Unlock();
+		return false;
+	}
+	Unlink(pNode);
+	m_TimerCounts.fetch_sub(1, std::memory_order_relaxed);
+	Unlock();
+	return true;
+}
+
+int32_t H1TimerWheel::Advance(uint64_t timestamp)
+{
+	uint64_t targetTick = timestamp / m_TickTimestamps;
+	H1TimerNode* pExpiredNodes = nullptr;
+
+	Lock();
+	while (m_CurrentTick < targetTick)
+	{
+		// nothing to expire; jump to the target tick directly
+		if (m_TimerCounts.load(std::memory_order_relaxed) == 0)
+		{
+			m_CurrentTick = targetTick;
+			break;
+		}
+
+		++m_CurrentTick;
+
+		// cascade from the top level; the nodes could be moved down to the slot cascaded next at the same tick
+		for (uint32_t level = LevelCounts - 1; level > 0; --level)
+		{
+			if ((m_CurrentTick & ((1ull << (SlotBits * level)) - 1)) == 0)
+				Cascade(level);
+		}
+
+		// all nodes in the slot of level 0 expire at this tick
+		H1TimerNode*& rSlotHead = m_Slots[0][m_CurrentTick & (SlotCounts - 1)];
+		while (rSlotHead != nullptr)
+		{
+			H1TimerNode* pNode = rSlotHead;
+			Unlink(pNode);
+			m_TimerCounts.fetch_sub(1, std::memory_order_relaxed);
+			pNode->Next = pExpiredNodes;
+			pExpiredNodes = pNode;
+		}
+	}
+	Unlock();
+
+	int32_t expiredCounts = 0;
+	while (pExpiredNodes != nullptr)
+	{
+		// get all before the callback; the node could be gone right after (e.g. the resumed fiber's stack)
+		H1TimerNode* pNextNode = pExpiredNodes->Next;
+		TimerCallback callback = pExpiredNodes->Callback;
+		void* data = pExpiredNodes->Data;
+		callback(data);
+
+		pExpiredNodes = pNextNode;
+		++expiredCounts;
+	}
+	return expiredCounts;
+}
+
+void H1TimerWheel::Link(H1TimerNode* pNode, uint64_t minExpireTick)
+{
+	// the timer already expired goes to the earliest slot not processed yet
+	uint64_t expireTick = pNode->ExpireTick > minExpireTick ? pNode->ExpireTick : minExpireTick;
+	uint64_t delta = expireTick - m_CurrentTick;
+
+	uint32_t level = 0;
+	while (level < LevelCounts - 1 && delta >= (1ull << (SlotBits * (level + 1))))
+		++level;
+
+	// beyond the range of the top level; park it in the farthest slot and link again when it is cascaded
+	const uint64_t maxDelta = (1ull << (SlotBits * LevelCounts)) - 1;
+	if (delta > maxDelta)
+		expireTick = m_CurrentTick + maxDelta;
+
+	H1TimerNode** pSlotHead = &m_Slots[level][(expireTick >> (SlotBits * level)) & (SlotCounts - 1)];
+	pNode->Prev = nullptr;
+	pNode->Next = *pSlotHead;
+	if (*pSlotHead != nullptr)
+		(*pSlotHead)->Prev = pNode;
+	*pSlotHead = pNode;
+	pNode->SlotHead = pSlotHead;
+}
+
+void H1TimerWheel::Unlink(H1TimerNode* pNode)
+{
+	if (pNode->Prev != nullptr)
+		pNode->Prev->Next = pNode->Next;
+	else
+		*pNode->SlotHead = pNode->Next;
+	if (pNode->Next != nullptr)
+		pNode->Next->Prev = pNode->Prev;
+
+	pNode->Prev = nullptr;
+	pNode->Next = nullptr;
+	pNode->SlotHead = nullptr;
+}
+
+void H1TimerWheel::Cascade(uint32_t level)
+{
+	// detach the slot reached by current tick and link its nodes again (to the lower levels)
+	//	- the slot of level 0 at current tick is processed right after the cascade, so the node expiring now still could be linked there
+	H1TimerNode*& rSlotHead = m_Slots[level][(m_CurrentTick >> (SlotBits * level)) & (SlotCounts - 1)];
+	H1TimerNode* pNode = rSlotHead;
+	rSlotHead = nullptr;
+	while (pNode != nullptr)
+	{
+		H1TimerNode* pNextNode = pNode->Next;
+		Link(pNode, m_CurrentTick);
+		pNode = pNextNode;
+	}
+}
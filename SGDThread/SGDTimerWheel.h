@@ -0,0 +1,103 @@
+// Simplified BSD license:
+// Copyright (c) 2016-2016, SangHyeok Hong.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// - Redistributions of source code must retain the above copyright notice, this list of
+// conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice, this list of
+// conditions and the following disclaimer in the documentation and/or other materials
+// provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+// OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+// TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+namespace SGD
+{
+	// called when the timer expires (after the wheel lock is released)
+	typedef void (*TimerCallback)(void* pData);
+
+	// intrusive timer node; the owner keeps it alive until it expires or is cancelled (e.g. on the sleeping fiber's stack)
+	struct H1TimerNode
+	{
+		H1TimerNode(TimerCallback callback = nullptr, void* data = nullptr)
+			: Callback(callback)
+			, Data(data)
+			, ExpireTick(0)
+			, Prev(nullptr)
+			, Next(nullptr)
+			, SlotHead(nullptr)
+		{}
+
+		TimerCallback Callback;
+		void* Data;
+		// below members are owned by H1TimerWheel
+		uint64_t ExpireTick;
+		H1TimerNode* Prev;
+		H1TimerNode* Next;
+		// head of the slot list linking this node (null when it is not scheduled)
+		H1TimerNode** SlotHead;
+	};
+
+	// hierarchical timing wheel (4 levels x 64 slots) ticking in the timestamp of appGetTimestamp
+	//	- O(1) insert and cancel: the node is linked into the slot by its expiration tick in doubly-linked list
+	//	- the nodes in the upper levels are cascaded down when the lower level wraps around
+	//	- the timer expiring beyond the range of the top level is parked in the top level and re-cascaded until it is in range
+	//	- one per worker thread, advanced by the worker loop; the spin-lock makes insert/cancel from other threads safe
+	class H1TimerWheel
+	{
+	public:
+		static const uint32_t LevelCounts = 4;
+		static const uint32_t SlotBits = 6;
+		static const uint32_t SlotCounts = 1 << SlotBits;
+		// default resolution of one tick (the accuracy of the timer)
+		static const uint32_t DefaultTickMicroseconds = 50;
+
+		H1TimerWheel();
+		~H1TimerWheel();
+
+		bool Initialize(uint32_t tickMicroseconds = DefaultTickMicroseconds);
+		void Destroy();
+
+		// schedule the node to expire at the timestamp (the timestamp in the past expires at the next advance)
+		//	- NOTE THAT - the node must not be scheduled already
+		void Insert(H1TimerNode* pNode, uint64_t expireTimestamp);
+		// return false when the node is not scheduled (already expired, or its callback is running)
+		bool Cancel(H1TimerNode* pNode);
+		// expire the timers up to the timestamp; return the number of expired timers
+		int32_t Advance(uint64_t timestamp);
+
+		// hint for skipping the advance; it could be stale
+		inline bool IsEmpty() const { return m_TimerCounts.load(std::memory_order_relaxed) == 0; }
+		inline uint64_t GetTickTimestamps() const { return m_TickTimestamps; }
+		// the last processed tick (timestamp / GetTickTimestamps())
+		inline uint64_t GetCurrentTick() const { return m_CurrentTick; }
+
+	private:
+		void Lock();
+		void Unlock();
+
+		// below methods require the lock
+		void Link(H1TimerNode* pNode, uint64_t minExpireTick);
+		void Unlink(H1TimerNode* pNode);
+		void Cascade(uint32_t level);
+
+		// timestamp ticks per wheel tick
+		uint64_t m_TickTimestamps;
+		// the last processed tick
+		uint64_t m_CurrentTick;
+		std::atomic<int32_t> m_TimerCounts;
+		std::atomic<bool> m_bLocked;
+		H1TimerNode* m_Slots[LevelCounts][SlotCounts];
+	};
+}
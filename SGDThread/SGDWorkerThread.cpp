@@ -29,6 +29,9 @@
 #include "SGDTaskScheduler.h"
 using namespace SGD;
 
+// worker thread bound to current OS thread
+static thread_local H1WorkerThread* gCurrentWorkerThread = nullptr;
+
 #if _WIN32
 uint32_t __stdcall WorkerThreadEntryPoint(void* Data)
 #endif
@@ -37,6 +40,7 @@ uint32_t __stdcall WorkerThreadEntryPoint(void* Data)
 	H1WorkerThread* pWorkerThread = reinterpret_cast<H1WorkerThread*>(Data);
 	// create thread fiber type
 	pWorkerThread->ConvertThreadToFiber();
+	gCurrentWorkerThread = pWorkerThread;
 	
 	// execute thread-main loop
 	while (true)
@@ -52,47 +56,72 @@ uint32_t __stdcall WorkerThreadEntryPoint(void* Data)
 		if (pTaskScheduler == nullptr) 
 			continue;
 
-		H1WaitFiberContextQueue& rWaitFiberContextQueue = pTaskScheduler->GetWaitFiberContextQueue();
+		// expire the timers; the sleeping fibers are moved to the ready-to-resume queue
+		if (!pWorkerThread->GetTimerWheel().IsEmpty())
+			pWorkerThread->GetTimerWheel().Advance(appGetTimestamp());
 
-		// @TODO - how to decide whether we dequeue fiber-context[big or small]? : temporary use small right now
-		H1FiberContext* fiberContextToProcess = nullptr;
-		FiberId newFiberContextId = pTaskScheduler->GetWaitFiberContextQueue().Dequeue(EFiberType::EFT_Small);
-		if (newFiberContextId != -1)
-		{
-			
-		}
+		// fiber context resumed by this worker thread (last ran here, its stack is likely still in the cache)
+		H1FiberContext* pFiberContextToProcess = pWorkerThread->GetReadyFiberContextQueue().Dequeue();
 		// 2. if there is no available task in wait queue, get the task from task queue
-		else
+		if (pFiberContextToProcess == nullptr)
 		{
-			H1TaskDeclaration* pNewTask = nullptr;
-			// high-priority queue
-			pNewTask = pTaskScheduler->GetTaskQueue(ETaskQueuePriority::ETQP_High)->DequeueTask();
-
-			// mid-priority queue
-			if (pNewTask == nullptr)
-				pNewTask = pTaskScheduler->GetTaskQueue(ETaskQueuePriority::ETQP_Mid)->DequeueTask();
-
-			// low-priority queue
-			if (pNewTask == nullptr)
-				pNewTask = pTaskScheduler->GetTaskQueue(ETaskQueuePriority::ETQP_Low)->DequeueTask();
-			
-			// there is no available task right now, skip to create and execute new fiber context
-			if (pNewTask == nullptr)
+			// earliest deadline task first, then high -> mid -> low priority queues
+			H1TaskDeclaration* pNewTask = pTaskScheduler->DequeueTask(pWorkerThread);
+			if (pNewTask != nullptr)
+			{
+				// cancelled task is skipped without fiber context; its task counter still reaches zero to wake up the waiter
+				if (pNewTask->IsCancelled())
+				{
+					pNewTask->SkipTask();
+					continue;
+				}
+
+				// construct new fiber context adding newly popped task
+				// @TODO - only handling small one right now
+				// 1) dequeue free fiber context
+				FiberId newFiberContextId = pTaskScheduler->GetFiberContextPool().DequeueFreeFiberContext(EFT_Small);
+				if (newFiberContextId == -1)
+				{
+					// all fiber contexts are in use (waiting); put the task back at its priority and try again later
+					//	- the fibers ready in other worker threads (busy ones) are resumed here to free the fiber contexts
+					pTaskScheduler->EnqueueTask(pNewTask, pNewTask->GetQueuePriority());
+					pFiberContextToProcess = pTaskScheduler->StealReadyFiberContext(pWorkerThread);
+				}
+				else
+				{
+					// 2) construct new fiber context with new task
+					pTaskScheduler->GetFiberContextPool().ConstructFiberContext(newFiberContextId, EFT_Small, pNewTask);
+					pFiberContextToProcess = pTaskScheduler->GetFiberContextPool().GetFiberContextSmall(newFiberContextId);
+				}
+			}
+			else
+			{
+				// there is no available task; steal the fiber context ready in other worker threads
+				pFiberContextToProcess = pTaskScheduler->StealReadyFiberContext(pWorkerThread);
+			}
+
+			// there is nothing to run right now; poll the I/O readiness without blocking and skip this iteration
+			//	- the fibers waiting for the ready descriptors are moved to the ready-to-resume queues
+			if (pFiberContextToProcess == nullptr)
+			{
+				pTaskScheduler->GetReactor().Poll(0);
 				continue;
-
-			// construct new fiber context adding newly popped task
-			// @TODO - only handling small one right now
-			// 1) dequeue free fiber context
-			newFiberContextId = pTaskScheduler->GetFiberContextPool().DequeueFreeFiberContext(EFT_Small);
-			// 2) construct new fiber context with new task
-			pTaskScheduler->GetFiberContextPool().ConstructFiberContext(newFiberContextId, EFT_Small, pNewTask);
+			}
 		}
 		
 		// 3. switch to fiber context with the task that we got
 		// process the fiber context
 		//	- it successfully finished current fiber-context 
 		//	- or it is suspended to wait child tasks to be finished
-		pWorkerThread->SwitchFiberContext(newFiberContextId, EFT_Small);
+		pWorkerThread->SwitchFiberContext(pFiberContextToProcess->GetFiberId(), pFiberContextToProcess->GetFiberType());
+
+		// 4. if the fiber context is parked, publish it to wait (or resume it immediately when its condition is already met)
+		H1FiberContext* pResumeFiberContext = pWorkerThread->ProcessParkedFiberContext();
+		while (pResumeFiberContext != nullptr)
+		{
+			pWorkerThread->SwitchFiberContext(pResumeFiberContext->GetFiberId(), pResumeFiberContext->GetFiberType());
+			pResumeFiberContext = pWorkerThread->ProcessParkedFiberContext();
+		}
 	}
 
 	// successfully quit the thread entry point
@@ -105,6 +134,9 @@ H1WorkerThread::H1WorkerThread()
 	, m_TaskScheduler(nullptr)
 	, m_FiberContextSlotId(-1)
 	, m_ThreadFiberContext(nullptr)
+	, m_ParkedFiberContext(nullptr)
+	, m_ParkCallback(nullptr)
+	, m_ParkCallbackData(nullptr)
 {
 	
 }
@@ -125,6 +157,10 @@ bool H1WorkerThread::Initialize(H1TaskScheduler* taskScheduler, int32_t lockedCP
 	// set task scheduler
 	m_TaskScheduler = taskScheduler;
 
+	// timer wheel ticking from now
+	if (!m_TimerWheel.Initialize())
+		return false;
+
 	return true;
 }
 
@@ -137,6 +173,8 @@ void H1WorkerThread::Destroy()
 		m_ThreadFiberContext = nullptr;
 	}		
 
+	m_TimerWheel.Destroy();
+
 	// in case, still worker thread is running, signal to quit
 	SignalQuit();
 }
@@ -163,6 +201,12 @@ void H1WorkerThread::SignalQuit()
 	m_IsQuit.store(true);
 }
 
+H1WorkerThread* H1WorkerThread::GetCurrentWorkerThread()
+{
+	// NOTE THAT - not inlined, the fiber could be resumed in other thread (don't cache thread local address across switching)
+	return gCurrentWorkerThread;
+}
+
 void H1WorkerThread::ConvertThreadToFiber()
 {
 	// create new fiber context, setting thread fiber type
@@ -209,6 +253,43 @@ H1FiberContext* H1WorkerThread::GetCurrentBindedFiberContext()
 	return pFiberContext;
 }
 
+void H1WorkerThread::ParkFiberContext(FiberContextParkCallback callback, void* data)
+{
+	// the callback is executed by thread fiber context (ProcessParkedFiberContext)
+	m_ParkedFiberContext = GetCurrentBindedFiberContext();
+	m_ParkCallback = callback;
+	m_ParkCallbackData = data;
+
+	SwitchThreadFiberContext();
+}
+
+H1FiberContext* H1WorkerThread::ProcessParkedFiberContext()
+{
+	if (m_ParkedFiberContext == nullptr)
+		return nullptr; // the fiber context is finished (or there is no parked one)
+
+	H1FiberContext* pFiberContext = m_ParkedFiberContext;
+	FiberContextParkCallback callback = m_ParkCallback;
+	void* data = m_ParkCallbackData;
+	m_ParkedFiberContext = nullptr;
+	m_ParkCallback = nullptr;
+	m_ParkCallbackData = nullptr;
+
+	// the fiber context finished its task slot; release it to the pool
+	if (callback == nullptr)
+	{
+		pFiberContext->ReleaseSlot();
+		m_TaskScheduler->GetFiberContextPool().EnqueueFreeFiberContext(pFiberContext->GetFiberId(), pFiberContext->GetFiberType());
+		return nullptr;
+	}
+
+	if (callback(pFiberContext, data))
+		return nullptr; // successfully parked; waker will move it to ready-to-resume queue
+
+	// the condition is already met, resume it immediately
+	return pFiberContext;
+}
+
 H1WorkerThreadPool::H1WorkerThreadPool()
 {
 
@@ -24,12 +24,72 @@
 #pragma once
 
 #include "SGDFiberContext.h"
+#include "SGDDeadlineTaskQueue.h"
+#include "SGDReadyFiberContextQueue.h"
+#include "SGDTimerWheel.h"
 
 namespace SGD
 {
 	// forward declaration
 	class H1TaskScheduler;
 
+	// callback executed in the thread fiber context after the fiber context is parked
+	//	- return true when the fiber context is published to be resumed later, false to resume it immediately
+	typedef bool (*FiberContextParkCallback)(H1FiberContext* pFiberContext, void* pData);
+
+	// tasks dequeued in batch by the worker thread
+	//	- refilled only by the owner from one priority queue when it is empty; tasks left in the shared queue are still stealable by others
+	//	- the buffered tasks are stealable too: the owner and the thieves claim the head by CAS (FIFO, single producer)
+	//	- the positions only increase, so the claim of the stale position fails after the refill
+	class H1LocalTaskBuffer
+	{
+	public:
+		static const int32_t Capacity = 32;
+
+		H1LocalTaskBuffer() : m_Head(0), m_Tail(0), m_Priority(ETQP_High) {}
+
+		inline bool IsEmpty() const { return m_Head.load(std::memory_order_relaxed) >= m_Tail.load(std::memory_order_relaxed); }
+		// priority queue which the buffered tasks came from
+		inline ETaskQueuePriority GetPriority() const { return m_Priority; }
+
+		// called by the owner and the thieves; return null when it is empty
+		H1TaskDeclaration* Pop()
+		{
+			uint64_t head = m_Head.load(std::memory_order_acquire);
+			while (true)
+			{
+				uint64_t tail = m_Tail.load(std::memory_order_acquire);
+				if (head >= tail)
+					return nullptr;
+
+				// the slot is not overwritten until the position is claimed (the refill waits for the empty buffer)
+				H1TaskDeclaration* pTask = m_Tasks[head % Capacity].load(std::memory_order_relaxed);
+				if (m_Head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+					return pTask;
+			}
+		}
+
+		// called by the owner when it is empty
+		void Refill(H1TaskDeclaration** ppTasks, int32_t taskCounts, ETaskQueuePriority tqPriority)
+		{
+			assert(IsEmpty() && taskCounts <= Capacity);
+			uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+			for (int32_t i = 0; i < taskCounts; ++i)
+				m_Tasks[(tail + i) % Capacity].store(ppTasks[i], std::memory_order_relaxed);
+			m_Priority = tqPriority;
+			// publish the tasks to the thieves
+			m_Tail.store(tail + taskCounts, std::memory_order_release);
+		}
+
+	private:
+		std::atomic<H1TaskDeclaration*> m_Tasks[Capacity];
+		// claimed by the owner and the thieves
+		std::atomic<uint64_t> m_Head;
+		// written only by the owner
+		std::atomic<uint64_t> m_Tail;
+		ETaskQueuePriority m_Priority;
+	};
+
 	class H1WorkerThread
 	{
 	public:
@@ -52,12 +112,28 @@ namespace SGD
 		void SwitchThreadFiberContext();
 		// get current binded fiber context
 		H1FiberContext* GetCurrentBindedFiberContext();
+		// worker thread running the caller (null in the thread which is not the worker thread e.g. main thread)
+		static H1WorkerThread* GetCurrentWorkerThread();
+
+		// park current binded fiber context and switch to thread fiber context
+		//	- the callback runs after leaving the fiber's stack, so the fiber could be resumed by other worker thread safely
+		//	- null callback means the fiber context finished its task slot (it is released to the fiber context pool)
+		//	- NOTE THAT - the fiber could be resumed in other worker thread, don't touch this worker thread after this call
+		void ParkFiberContext(FiberContextParkCallback callback, void* data);
+		// run the park callback in thread fiber context; return the fiber context to resume immediately (or null)
+		H1FiberContext* ProcessParkedFiberContext();
 
 		inline int32_t GetCPUCoreId() { return m_CPUCoreId; }
+		// index in the worker thread pool (same as locked CPU core id)
+		inline int32_t GetWorkerThreadIndex() { return m_CPUCoreId; }
 		inline ThreadId GetThreadId() { return m_ThreadId; }
 		inline ThreadType GetThreadHandle() { return m_ThreadHandle; }
 		inline H1TaskScheduler* GetTaskScheduler() { return m_TaskScheduler; }
 		inline H1FiberContext* GetThreadFiberContext() { return m_ThreadFiberContext; }
+		inline H1DeadlineTaskQueue& GetDeadlineTaskQueue() { return m_DeadlineTaskQueue; }
+		inline H1LocalTaskBuffer& GetLocalTaskBuffer() { return m_LocalTaskBuffer; }
+		inline H1ReadyFiberContextQueue& GetReadyFiberContextQueue() { return m_ReadyFiberContextQueue; }
+		inline H1TimerWheel& GetTimerWheel() { return m_TimerWheel; }
 
 	private:
 		// task scheduler reference
@@ -73,6 +149,18 @@ namespace SGD
 		FiberId m_FiberContextSlotId;
 		// thread's fiber context
 		H1FiberContext* m_ThreadFiberContext;
+		// fiber context parked by ParkFiberContext (waiting for the thread fiber context to run the callback)
+		H1FiberContext* m_ParkedFiberContext;
+		FiberContextParkCallback m_ParkCallback;
+		void* m_ParkCallbackData;
+		// tasks with the deadline assigned to this worker thread
+		H1DeadlineTaskQueue m_DeadlineTaskQueue;
+		// tasks dequeued in batch from the priority queues
+		H1LocalTaskBuffer m_LocalTaskBuffer;
+		// fiber contexts suspended in this worker thread and ready to resume
+		H1ReadyFiberContextQueue m_ReadyFiberContextQueue;
+		// timers of the fibers parked in this worker thread (e.g. sleeping fibers), advanced by the worker loop
+		H1TimerWheel m_TimerWheel;
 		// quit atomic counter
 		std::atomic_bool m_IsQuit;
 	};
@@ -87,6 +175,8 @@ namespace SGD
 		void Destroy();
 
 		H1WorkerThread* GetWorkerThreadById(ThreadId threadId);
+		inline H1WorkerThread* GetWorkerThreadByIndex(uint32_t index) { return m_WorkerThreads[index]; }
+		inline uint32_t GetWorkerThreadCounts() const { return static_cast<uint32_t>(m_WorkerThreads.size()); }
 		inline H1WorkerThread* GetFirstThread() { return m_WorkerThreads.size() > 0 ? m_WorkerThreads[0] : nullptr; }
 
 		UNIT_TEST_VIRTUAL bool StartAll();
@@ -1,5 +1,7 @@
 #pragma once
 
+// winsock2 should precede windows.h
+#include <winsock2.h>
 #include <windows.h>
 #include <stdio.h>
 
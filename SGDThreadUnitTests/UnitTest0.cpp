@@ -1,6 +1,23 @@
 #include "SGDThreadUnitTestsPCH.h"
 #include "SGDTaskScheduler.h"
 #include "SGDWorkerThread.h"
+#include "SGDTaskGraph.h"
+#include "SGDTaskFuture.h"
+#include "SGDTaskCoroutine.h"
+#include "SGDFramePipeline.h"
+#include "SGDTaggedHeap.h"
+#include "SGDIntrusiveTaskQueue.h"
+#include "SGDReadyFiberContextQueue.h"
+#include "SGDBoundedQueue.h"
+#include "SGDFiberMutex.h"
+#include "SGDFiberSemaphore.h"
+#include "SGDFiberConditionVariable.h"
+#include "SGDFiberReaderWriterLock.h"
+#include "SGDFiberBarrier.h"
+#include "SGDFiberChannel.h"
+#include "SGDTimerWheel.h"
+#include "SGDReactor.h"
+#include "SGDAsyncFile.h"
 
 // the fixture for testing class
 class TaskSchedulerTest : public ::testing::Test 
@@ -147,4 +164,1991 @@ TEST_F(TaskSchedulerTest, TaskSchedulerLayerExecuteRecursiveAndMultipleTasks)
 
 	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
 	EXPECT_EQ(true, SGD::H1TaskSchedulerLayer::GetTaskScheduler() == nullptr);
-}
\ No newline at end of file
+}
+
+struct GraphNodeData
+{
+	int32_t value;
+	GraphNodeData* inputs[2];
+	std::atomic<int32_t>* order;
+	int32_t visitOrder;
+};
+
+START_TASK_ENTRY_POINT(GraphNode)
+{
+	GraphNodeData* pData = reinterpret_cast<GraphNodeData*>(pTaskData_GraphNode);
+	for (int32_t i = 0; i < 2; ++i)
+	{
+		if (pData->inputs[i] != nullptr)
+			pData->value += pData->inputs[i]->value;
+	}
+	pData->visitOrder = pData->order->fetch_add(1);
+}
+
+TEST_F(TaskSchedulerTest, TaskGraphCompileAndReplay)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// diamond graph: A -> (B, C) -> D
+	std::atomic<int32_t> order(0);
+	GraphNodeData nodeData[4];
+	SGD::H1TaskGraph graph;
+	SGD::H1TaskGraph::NodeId nodes[4];
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		nodeData[i].order = &order;
+		nodeData[i].inputs[0] = nodeData[i].inputs[1] = nullptr;
+		nodes[i] = graph.AddNode(TaskEntryPoint_GraphNode, &nodeData[i]);
+	}
+	nodeData[1].inputs[0] = &nodeData[0];
+	nodeData[2].inputs[0] = &nodeData[0];
+	nodeData[3].inputs[0] = &nodeData[1];
+	nodeData[3].inputs[1] = &nodeData[2];
+	graph.AddDependency(nodes[0], nodes[1]);
+	graph.AddDependency(nodes[0], nodes[2]);
+	graph.AddDependency(nodes[1], nodes[3]);
+	graph.AddDependency(nodes[2], nodes[3]);
+	EXPECT_EQ(true, graph.Compile());
+
+	// replay the same compiled graph several times
+	for (int32_t frame = 0; frame < 3; ++frame)
+	{
+		order.store(0);
+		for (int32_t i = 0; i < 4; ++i)
+			nodeData[i].value = 1;
+
+		SGD::H1TaskCounter* counter = nullptr;
+		EXPECT_EQ(true, graph.Run(&counter));
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+
+		EXPECT_EQ(5, nodeData[3].value);
+		EXPECT_EQ(0, nodeData[0].visitOrder);
+		EXPECT_EQ(3, nodeData[3].visitOrder);
+	}
+
+	// cycle is rejected
+	graph.AddDependency(nodes[3], nodes[0]);
+	EXPECT_EQ(false, graph.Compile());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct SumResultsData
+{
+	int32_t* results;
+	int32_t resultCounts;
+	int32_t sum;
+};
+
+START_TASK_ENTRY_POINT(SumResults)
+{
+	SumResultsData* pData = reinterpret_cast<SumResultsData*>(pTaskData_SumResults);
+	pData->sum = 0;
+	for (int32_t i = 0; i < pData->resultCounts; ++i)
+		pData->sum += pData->results[i];
+}
+
+TEST_F(TaskSchedulerTest, TaskCounterContinuations)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// stage 1 - add numbers
+	int32_t arrResults[4] = { 0, };
+	AddNumberData arrNumberData[4];
+	SGD::H1TaskDeclaration addTasks[4];
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		arrNumberData[i].a = i;
+		arrNumberData[i].b = i + 1;
+		arrNumberData[i].result = &arrResults[i];
+		addTasks[i].SetTaskEntryPoint(TaskEntryPoint_AddNumber);
+		addTasks[i].SetTaskData(&arrNumberData[i]);
+	}
+
+	// stage 2 - sum results after stage 1 (continuation)
+	SumResultsData sumData = { arrResults, 4, 0 };
+	SGD::H1TaskDeclaration sumTask(TaskEntryPoint_SumResults, &sumData);
+	SGD::H1TaskCounter sumCounter;
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(addTasks, 4, &counter);
+	EXPECT_EQ(true, SGD::H1TaskSchedulerLayer::RunTasksAfter(counter, &sumTask, 1, &sumCounter));
+	SGD::H1TaskSchedulerLayer::WaitForCounter(&sumCounter);
+	EXPECT_EQ(16, sumData.sum);
+
+	// the continuation attached to already finished counter runs immediately
+	sumData.sum = 0;
+	EXPECT_EQ(true, SGD::H1TaskSchedulerLayer::RunTasksAfter(counter, &sumTask, 1, &sumCounter));
+	SGD::H1TaskSchedulerLayer::WaitForCounter(&sumCounter);
+	EXPECT_EQ(16, sumData.sum);
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+START_TYPED_TASK_ENTRY_POINT(int32_t, MultiplyNumber)
+{
+	AddNumberData* pData = reinterpret_cast<AddNumberData*>(pTaskData_MultiplyNumber);
+	return pData->a * pData->b;
+}
+
+struct FutureTestData
+{
+	int32_t whenAllSum;
+	int32_t whenAnyIndex;
+	int32_t getResult;
+};
+
+START_TASK_ENTRY_POINT(FutureLoop)
+{
+	FutureTestData* pResult = reinterpret_cast<FutureTestData*>(pTaskData_FutureLoop);
+
+	AddNumberData arrNumberData[4];
+	SGD::H1TypedTaskDeclaration<int32_t> typedTasks[4];
+	SGD::H1TaskFuture<int32_t> futures[4];
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		arrNumberData[i].a = i + 1;
+		arrNumberData[i].b = 10;
+		typedTasks[i].SetTaskEntryPoint(TypedTaskEntryPoint_MultiplyNumber);
+		typedTasks[i].SetTaskData(&arrNumberData[i]);
+		futures[i] = SGD::RunTypedTask(typedTasks[i]);
+	}
+
+	SGD::WhenAll(futures, 4);
+	pResult->whenAllSum = 0;
+	for (int32_t i = 0; i < 4; ++i)
+		pResult->whenAllSum += futures[i].Get();
+
+	// respawn two of them and wait for any
+	futures[0] = SGD::RunTypedTask(typedTasks[0]);
+	futures[1] = SGD::RunTypedTask(typedTasks[1]);
+	pResult->whenAnyIndex = SGD::WhenAny(futures, 2);
+	pResult->getResult = futures[0].Get() + futures[1].Get();
+}
+
+TEST_F(TaskSchedulerTest, TypedTaskFutures)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	FutureTestData result = { 0, -1, 0 };
+	SGD::H1TaskDeclaration task(TaskEntryPoint_FutureLoop, &result);
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(&task, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+
+	EXPECT_EQ(100, result.whenAllSum);
+	EXPECT_EQ(true, result.whenAnyIndex == 0 || result.whenAnyIndex == 1);
+	EXPECT_EQ(30, result.getResult);
+
+	// future could be waited in the main thread too
+	AddNumberData numberData = { 6, 7, nullptr };
+	SGD::H1TypedTaskDeclaration<int32_t> typedTask(TypedTaskEntryPoint_MultiplyNumber, &numberData);
+	SGD::H1TaskFuture<int32_t> future = SGD::RunTypedTask(typedTask);
+	EXPECT_EQ(42, future.Get());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct CancellationTestData
+{
+	std::atomic<int32_t> startedCounts;
+	std::atomic<int32_t> observedCounts;
+};
+
+START_TASK_ENTRY_POINT(PollCancellation)
+{
+	CancellationTestData* pData = reinterpret_cast<CancellationTestData*>(pTaskData_PollCancellation);
+	pData->startedCounts++;
+
+	// long running task-body polls the cancellation inherited from the parent task
+	while (!SGD::H1TaskSchedulerLayer::IsCurrentTaskCancelled()) {}
+	pData->observedCounts++;
+}
+
+START_TASK_ENTRY_POINT(SpawnPollCancellation)
+{
+	SGD::H1TaskDeclaration tasks[8];
+	for (int32_t i = 0; i < 8; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_PollCancellation);
+		tasks[i].SetTaskData(pTaskData_SpawnPollCancellation);
+	}
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 8, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+}
+
+TEST_F(TaskSchedulerTest, HierarchicalTaskCancellation)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// 1) tasks cancelled before they are dequeued are skipped, but the counter still reaches zero
+	SGD::H1TaskCancellationToken rootToken;
+	SGD::H1TaskCancellationToken childToken(&rootToken);
+	rootToken.Cancel();
+	EXPECT_EQ(true, childToken.IsCancelled());
+
+	int32_t arrResults[16] = { 0, };
+	AddNumberData arrNumberData[16];
+	SGD::H1TaskDeclaration addTasks[16];
+	for (int32_t i = 0; i < 16; ++i)
+	{
+		arrNumberData[i].a = i;
+		arrNumberData[i].b = 1;
+		arrNumberData[i].result = &arrResults[i];
+		addTasks[i].SetTaskEntryPoint(TaskEntryPoint_AddNumber);
+		addTasks[i].SetTaskData(&arrNumberData[i]);
+		addTasks[i].SetCancellationToken(&childToken);
+	}
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(addTasks, 16, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	for (int32_t i = 0; i < 16; ++i)
+		EXPECT_EQ(0, arrResults[i]);
+
+	// 2) running children (inheriting the token through the parent task) observe the cancellation of the root
+	//	- the cached state of the child is invalidated by the reset of the root
+	rootToken.Reset();
+	EXPECT_EQ(false, childToken.IsCancelled());
+	EXPECT_EQ(false, SGD::H1TaskCancellationToken::IsAnyCancelled());
+	CancellationTestData data;
+	data.startedCounts = 0;
+	data.observedCounts = 0;
+	SGD::H1TaskDeclaration spawnTask(TaskEntryPoint_SpawnPollCancellation, &data);
+	spawnTask.SetCancellationToken(&childToken);
+	SGD::H1TaskSchedulerLayer::RunTasks(&spawnTask, 1, &counter);
+
+	while (data.startedCounts.load() == 0) {}
+	rootToken.Cancel();
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	EXPECT_EQ(true, data.observedCounts.load() >= 1);
+	EXPECT_EQ(data.startedCounts.load(), data.observedCounts.load());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+TEST_F(TaskSchedulerTest, DeadlineTaskScheduling)
+{
+	// earliest deadline first in the worker's deadline task queue
+	SGD::H1DeadlineTaskQueue deadlineTaskQueue;
+	SGD::H1TaskDeclaration deadlineTasks[4];
+	const uint64_t deadlines[4] = { 400, 100, 300, 200 };
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		deadlineTasks[i].SetDeadline(deadlines[i]);
+		deadlineTaskQueue.EnqueueTask(&deadlineTasks[i]);
+	}
+	EXPECT_EQ(&deadlineTasks[1], deadlineTaskQueue.DequeueTask());
+	// the tasks already moved into the heap are still stealable (earliest first)
+	EXPECT_EQ(&deadlineTasks[3], deadlineTaskQueue.StealTask());
+	EXPECT_EQ(&deadlineTasks[2], deadlineTaskQueue.DequeueTask());
+	EXPECT_EQ(&deadlineTasks[0], deadlineTaskQueue.StealTask());
+	EXPECT_EQ(nullptr, deadlineTaskQueue.DequeueTask());
+	EXPECT_EQ(nullptr, deadlineTaskQueue.StealTask());
+
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+	SGD::H1DeadlineMetrics& rDeadlineMetrics = SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetDeadlineMetrics();
+
+	// mixed tasks: already expired deadline, far deadline and no deadline (FIFO)
+	int32_t arrResults[12] = { 0, };
+	AddNumberData arrNumberData[12];
+	SGD::H1TaskDeclaration addTasks[12];
+	for (int32_t i = 0; i < 12; ++i)
+	{
+		arrNumberData[i].a = i;
+		arrNumberData[i].b = 1;
+		arrNumberData[i].result = &arrResults[i];
+		addTasks[i].SetTaskEntryPoint(TaskEntryPoint_AddNumber);
+		addTasks[i].SetTaskData(&arrNumberData[i]);
+		if (i < 4)
+			addTasks[i].SetDeadline(1);
+		else if (i < 8)
+			addTasks[i].SetDeadline(SGD::H1TaskSchedulerLayer::GetDeadlineAfter(60 * 1000 * 1000));
+	}
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(addTasks, 12, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	for (int32_t i = 0; i < 12; ++i)
+		EXPECT_EQ(i + 1, arrResults[i]);
+
+	SGD::H1DeadlineFrameMetrics frameMetrics = rDeadlineMetrics.AdvanceFrame();
+	EXPECT_EQ(0, frameMetrics.FrameIndex);
+	EXPECT_EQ(8, frameMetrics.DeadlineTaskCounts);
+	EXPECT_EQ(4, frameMetrics.DeadlineMissCounts);
+	EXPECT_EQ(0, rDeadlineMetrics.GetCurrentFrameMetrics().DeadlineTaskCounts);
+	EXPECT_EQ(1, rDeadlineMetrics.GetCurrentFrameMetrics().FrameIndex);
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct FrameTaskData
+{
+	std::atomic<int32_t>* finishedCounts;
+	std::atomic<int32_t>* retiredCounts;
+};
+
+START_TASK_ENTRY_POINT(FrameWork)
+{
+	FrameTaskData* pData = reinterpret_cast<FrameTaskData*>(pTaskData_FrameWork);
+	// simulate some work to keep the frame in flight
+	volatile int32_t work = 0;
+	for (int32_t i = 0; i < 10000; ++i)
+		work = work + i;
+	(*pData->finishedCounts)++;
+}
+
+START_TASK_ENTRY_POINT(FrameRetire)
+{
+	FrameTaskData* pData = reinterpret_cast<FrameTaskData*>(pTaskData_FrameRetire);
+	(*pData->retiredCounts)++;
+}
+
+TEST_F(TaskSchedulerTest, FramePipelineBackPressure)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	const int32_t frameCounts = 8;
+	const int32_t pipelineDepth = 2;
+	SGD::H1FramePipeline framePipeline;
+	EXPECT_EQ(true, framePipeline.Initialize(pipelineDepth));
+
+	std::atomic<int32_t> finishedCounts[frameCounts];
+	std::atomic<int32_t> retiredCounts[frameCounts];
+	FrameTaskData frameData[frameCounts];
+	SGD::H1TaskDeclaration frameTasks[pipelineDepth][4];
+	// retire tasks could run after the slot is reused, so they are not shared between frames
+	SGD::H1TaskDeclaration retireTasks[frameCounts];
+	SGD::H1TaskCounter retireCounter;
+
+	for (int32_t frame = 0; frame < frameCounts; ++frame)
+	{
+		finishedCounts[frame] = 0;
+		retiredCounts[frame] = 0;
+		frameData[frame].finishedCounts = &finishedCounts[frame];
+		frameData[frame].retiredCounts = &retiredCounts[frame];
+
+		SGD::H1FrameContext* pFrameContext = framePipeline.BeginFrame();
+		EXPECT_EQ(static_cast<uint64_t>(frame), pFrameContext->GetFrameIndex());
+
+		// frame (N - depth) is retired before frame N begins
+		if (frame >= pipelineDepth)
+		{
+			EXPECT_EQ(true, framePipeline.IsFrameRetired(frame - pipelineDepth));
+			EXPECT_EQ(4, finishedCounts[frame - pipelineDepth].load());
+		}
+
+		// declarations of the slot are reused after the frame in the slot retires
+		int32_t slot = frame % pipelineDepth;
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			frameTasks[slot][i].SetTaskEntryPoint(TaskEntryPoint_FrameWork);
+			frameTasks[slot][i].SetTaskData(&frameData[frame]);
+		}
+		retireTasks[frame].SetTaskEntryPoint(TaskEntryPoint_FrameRetire);
+		retireTasks[frame].SetTaskData(&frameData[frame]);
+
+		EXPECT_EQ(true, framePipeline.RunTasksOnRetire(pFrameContext, &retireTasks[frame], 1, &retireCounter));
+		EXPECT_EQ(true, framePipeline.RunTasks(pFrameContext, frameTasks[slot], 4));
+		framePipeline.EndFrame(pFrameContext);
+	}
+
+	framePipeline.Flush();
+	for (int32_t frame = 0; frame < frameCounts; ++frame)
+	{
+		EXPECT_EQ(true, framePipeline.IsFrameRetired(frame));
+		EXPECT_EQ(4, finishedCounts[frame].load());
+	}
+	framePipeline.Destroy();
+
+	SGD::H1TaskSchedulerLayer::WaitForCounter(&retireCounter);
+	for (int32_t frame = 0; frame < frameCounts; ++frame)
+		EXPECT_EQ(1, retiredCounts[frame].load());
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct TaggedHeapTestData
+{
+	SGD::H1TaggedHeap* taggedHeap;
+	SGD::H1MemoryTag tag;
+	int32_t taskIndex;
+	int32_t* buffers[64];
+};
+
+START_TASK_ENTRY_POINT(TaggedHeapAllocate)
+{
+	TaggedHeapTestData* pData = reinterpret_cast<TaggedHeapTestData*>(pTaskData_TaggedHeapAllocate);
+	for (int32_t i = 0; i < 64; ++i)
+	{
+		pData->buffers[i] = pData->taggedHeap->AllocateArray<int32_t>(pData->tag, 16);
+		for (int32_t j = 0; j < 16; ++j)
+			pData->buffers[i][j] = pData->taskIndex;
+	}
+}
+
+TEST_F(TaskSchedulerTest, TaggedHeapAllocateAndRelease)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	SGD::H1TaggedHeap taggedHeap;
+	EXPECT_EQ(true, taggedHeap.Initialize(SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().GetWorkerThreadCounts()));
+
+	// allocations of the tasks running on different worker threads never overlap
+	TaggedHeapTestData taskData[32];
+	SGD::H1TaskDeclaration tasks[32];
+	for (int32_t i = 0; i < 32; ++i)
+	{
+		taskData[i].taggedHeap = &taggedHeap;
+		taskData[i].tag = 0;
+		taskData[i].taskIndex = i;
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_TaggedHeapAllocate);
+		tasks[i].SetTaskData(&taskData[i]);
+	}
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 32, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	int32_t mismatchCounts = 0;
+	for (int32_t i = 0; i < 32; ++i)
+	{
+		for (int32_t k = 0; k < 64; ++k)
+		{
+			if (reinterpret_cast<uintptr_t>(taskData[i].buffers[k]) % alignof(int32_t) != 0)
+				++mismatchCounts;
+			for (int32_t j = 0; j < 16; ++j)
+			{
+				if (taskData[i].buffers[k][j] != i)
+					++mismatchCounts;
+			}
+		}
+	}
+	EXPECT_EQ(0, mismatchCounts);
+	taggedHeap.Release(0);
+
+	// blocks of released tag are recycled by the next tag
+	const int32_t allocationCounts = (3 * 1024 * 1024) / 64;
+	int32_t failedCounts = 0;
+	for (int32_t i = 0; i < allocationCounts; ++i)
+	{
+		if (taggedHeap.Allocate(1, 64) == nullptr)
+			++failedCounts;
+	}
+	EXPECT_EQ(0, failedCounts);
+	int32_t blockCounts = taggedHeap.GetBlockCounts();
+	taggedHeap.Release(1);
+	for (int32_t i = 0; i < allocationCounts; ++i)
+	{
+		if (taggedHeap.Allocate(1 + SGD::H1TaggedHeap::MaxTagSlots, 64) == nullptr)
+			++failedCounts;
+	}
+	EXPECT_EQ(0, failedCounts);
+	EXPECT_EQ(blockCounts, taggedHeap.GetBlockCounts());
+
+	// too big allocation for the block
+	EXPECT_EQ(nullptr, taggedHeap.Allocate(2, SGD::H1TaggedHeap::BlockSize));
+	taggedHeap.Destroy();
+	EXPECT_EQ(0, taggedHeap.GetBlockCounts());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct ScratchArenaTestData
+{
+	int32_t sum;
+	size_t usedSizeAtStart;
+	bool bScopePopped;
+};
+
+START_TASK_ENTRY_POINT(ScratchArenaSum)
+{
+	ScratchArenaTestData* pData = reinterpret_cast<ScratchArenaTestData*>(pTaskData_ScratchArenaSum);
+	SGD::H1ScratchArena* pScratchArena = SGD::H1TaskSchedulerLayer::GetCurrentScratchArena();
+	pData->usedSizeAtStart = pScratchArena->GetUsedSize();
+
+	// temporaries bigger than small fiber stack; they are not popped (reset when the fiber returns to the pool)
+	int32_t* values = pScratchArena->AllocateArray<int32_t>(32 * 1024);
+	for (int32_t i = 0; i < 32 * 1024; ++i)
+		values[i] = 1;
+
+	SGD::H1ScratchArena::Marker marker = pScratchArena->Push();
+	{
+		SGD::H1ScratchScope scratchScope(*pScratchArena);
+		int32_t* scopedValues = pScratchArena->AllocateArray<int32_t>(1024);
+		for (int32_t i = 0; i < 1024; ++i)
+			scopedValues[i] = values[i];
+	}
+	pData->bScopePopped = (marker == pScratchArena->Push());
+
+	pData->sum = 0;
+	for (int32_t i = 0; i < 32 * 1024; ++i)
+		pData->sum += values[i];
+}
+
+TEST_F(TaskSchedulerTest, FiberScratchArena)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// main thread has no fiber context
+	EXPECT_EQ(nullptr, SGD::H1TaskSchedulerLayer::GetCurrentScratchArena());
+
+	ScratchArenaTestData taskData[16];
+	SGD::H1TaskDeclaration tasks[16];
+	SGD::H1TaskCounter* counter = nullptr;
+	for (int32_t batch = 0; batch < 4; ++batch)
+	{
+		for (int32_t i = 0; i < 16; ++i)
+		{
+			taskData[i] = { 0, 1, false };
+			tasks[i].SetTaskEntryPoint(TaskEntryPoint_ScratchArenaSum);
+			tasks[i].SetTaskData(&taskData[i]);
+		}
+
+		SGD::H1TaskSchedulerLayer::RunTasks(tasks, 16, &counter);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		for (int32_t i = 0; i < 16; ++i)
+		{
+			EXPECT_EQ(32 * 1024, taskData[i].sum);
+			EXPECT_EQ(0, taskData[i].usedSizeAtStart);
+			EXPECT_EQ(true, taskData[i].bScopePopped);
+		}
+	}
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+START_TASK_ENTRY_POINT(IncrementCounts)
+{
+	std::atomic<int32_t>* pCounts = reinterpret_cast<std::atomic<int32_t>*>(pTaskData_IncrementCounts);
+	(*pCounts)++;
+}
+
+START_TASK_ENTRY_POINT(SpawnDetachedTasks)
+{
+	// the spawner returns without waiting for the spawned tasks
+	for (int32_t i = 0; i < 1000; ++i)
+		SGD::H1TaskSchedulerLayer::SpawnTask(TaskEntryPoint_IncrementCounts, pTaskData_SpawnDetachedTasks);
+}
+
+TEST_F(TaskSchedulerTest, PooledFireAndForgetTasks)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// detached tasks spawned in the task
+	std::atomic<int32_t> counts(0);
+	SGD::H1TaskDeclaration spawnTask(TaskEntryPoint_SpawnDetachedTasks, &counts);
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(&spawnTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	while (counts.load() != 1000) {}
+
+	// spawned tasks tracked by the counter; the declarations are recycled
+	SGD::H1TaskCounter spawnCounter;
+	for (int32_t round = 0; round < 5; ++round)
+	{
+		counts = 0;
+		for (int32_t i = 0; i < 1000; ++i)
+			SGD::H1TaskSchedulerLayer::SpawnTask(TaskEntryPoint_IncrementCounts, &counts, &spawnCounter);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(&spawnCounter);
+		EXPECT_EQ(1000, counts.load());
+	}
+	// bounded by the tasks in flight and the free lists of the worker threads (not by the total number of spawned tasks)
+	int32_t maxAllocatedCounts = 2000 + SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().GetWorkerThreadCounts()
+		* (SGD::H1TaskDeclarationPool::MaxLocalFreeCounts + SGD::H1TaskDeclarationPool::ChunkSize);
+	EXPECT_GE(maxAllocatedCounts, SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetTaskDeclarationPool().GetAllocatedCounts());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+TEST_F(TaskSchedulerTest, TaskQueueBulkEnqueueDequeue)
+{
+	SGD::H1TaskQueue taskQueue(SGD::ETQP_High);
+	SGD::H1TaskDeclaration tasks[100];
+	EXPECT_EQ(true, taskQueue.EnqueueTaskRange(tasks, 100));
+
+	// the addresses of the tasks are enqueued in order
+	SGD::H1TaskDeclaration* dequeuedTasks[64];
+	EXPECT_EQ(64, taskQueue.DequeueTaskBulk(dequeuedTasks, 64));
+	for (int32_t i = 0; i < 64; ++i)
+		EXPECT_EQ(&tasks[i], dequeuedTasks[i]);
+	EXPECT_EQ(36, taskQueue.DequeueTaskBulk(dequeuedTasks, 64));
+	for (int32_t i = 0; i < 36; ++i)
+		EXPECT_EQ(&tasks[64 + i], dequeuedTasks[i]);
+	EXPECT_EQ(0, taskQueue.DequeueTaskBulk(dequeuedTasks, 64));
+	EXPECT_EQ(nullptr, taskQueue.DequeueTask());
+}
+
+TEST_F(TaskSchedulerTest, IntrusiveTaskQueue)
+{
+	// FIFO order in the batch
+	SGD::H1IntrusiveTaskQueue taskQueue;
+	SGD::H1TaskDeclaration tasks[8];
+	EXPECT_EQ(true, taskQueue.EnqueueTaskRange(tasks, 4));
+	EXPECT_EQ(true, taskQueue.EnqueueTask(&tasks[4]));
+	for (int32_t i = 0; i < 5; ++i)
+		EXPECT_EQ(&tasks[i], taskQueue.DequeueTask());
+	EXPECT_EQ(nullptr, taskQueue.DequeueTask());
+
+	// multiple producers & consumers; every task is dequeued exactly once
+	const int32_t producerCounts = 4;
+	const int32_t consumerCounts = 4;
+	const int32_t taskCountsPerProducer = 20000;
+	const int32_t batchSize = 100;
+	std::vector<SGD::H1TaskDeclaration> stressTasks(producerCounts * taskCountsPerProducer);
+	std::vector<std::atomic<int32_t>> dequeuedCounts(stressTasks.size());
+	for (size_t i = 0; i < stressTasks.size(); ++i)
+		dequeuedCounts[i] = 0;
+
+	std::atomic<int32_t> totalDequeuedCounts(0);
+	std::vector<std::thread> threads;
+	for (int32_t producer = 0; producer < producerCounts; ++producer)
+	{
+		threads.emplace_back([&, producer]()
+		{
+			SGD::H1TaskDeclaration* pTasks = &stressTasks[producer * taskCountsPerProducer];
+			for (int32_t i = 0; i < taskCountsPerProducer; i += batchSize)
+				taskQueue.EnqueueTaskRange(pTasks + i, batchSize);
+		});
+	}
+	for (int32_t consumer = 0; consumer < consumerCounts; ++consumer)
+	{
+		threads.emplace_back([&]()
+		{
+			SGD::H1TaskDeclaration* dequeuedTasks[16];
+			while (totalDequeuedCounts.load() < static_cast<int32_t>(stressTasks.size()))
+			{
+				int32_t counts = taskQueue.DequeueTaskBulk(dequeuedTasks, 16);
+				for (int32_t i = 0; i < counts; ++i)
+				{
+					dequeuedCounts[dequeuedTasks[i] - stressTasks.data()]++;
+				}
+				totalDequeuedCounts += counts;
+			}
+		});
+	}
+	for (std::thread& rThread : threads)
+		rThread.join();
+
+	for (size_t i = 0; i < stressTasks.size(); ++i)
+		EXPECT_EQ(1, dequeuedCounts[i].load());
+	EXPECT_EQ(nullptr, taskQueue.DequeueTask());
+}
+
+TEST_F(TaskSchedulerTest, ReadyFiberContextQueue)
+{
+	// FIFO order (the fiber context is not initialized; only its link is used)
+	SGD::H1ReadyFiberContextQueue readyQueue;
+	SGD::H1FiberContextWindow fiberContexts[4];
+	EXPECT_EQ(nullptr, readyQueue.Dequeue());
+	for (int32_t i = 0; i < 4; ++i)
+		readyQueue.Enqueue(&fiberContexts[i]);
+	for (int32_t i = 0; i < 4; ++i)
+		EXPECT_EQ(&fiberContexts[i], readyQueue.Dequeue());
+	EXPECT_EQ(true, readyQueue.IsEmpty());
+	EXPECT_EQ(nullptr, readyQueue.Dequeue());
+
+	// multiple producers & one consumer; every fiber context is dequeued exactly once
+	const int32_t producerCounts = 4;
+	const int32_t fiberContextCountsPerProducer = 20000;
+	std::vector<SGD::H1FiberContextWindow> stressFiberContexts(producerCounts * fiberContextCountsPerProducer);
+	std::vector<int32_t> dequeuedCounts(stressFiberContexts.size(), 0);
+
+	std::vector<std::thread> threads;
+	for (int32_t producer = 0; producer < producerCounts; ++producer)
+	{
+		threads.emplace_back([&, producer]()
+		{
+			for (int32_t i = 0; i < fiberContextCountsPerProducer; ++i)
+				readyQueue.Enqueue(&stressFiberContexts[producer * fiberContextCountsPerProducer + i]);
+		});
+	}
+
+	int32_t totalDequeuedCounts = 0;
+	while (totalDequeuedCounts < static_cast<int32_t>(stressFiberContexts.size()))
+	{
+		SGD::H1FiberContext* pFiberContext = readyQueue.Dequeue();
+		if (pFiberContext == nullptr)
+			continue;
+		dequeuedCounts[static_cast<SGD::H1FiberContextWindow*>(pFiberContext) - stressFiberContexts.data()]++;
+		++totalDequeuedCounts;
+	}
+	for (std::thread& rThread : threads)
+		rThread.join();
+
+	for (size_t i = 0; i < stressFiberContexts.size(); ++i)
+		EXPECT_EQ(1, dequeuedCounts[i]);
+	EXPECT_EQ(nullptr, readyQueue.Dequeue());
+}
+
+TEST_F(TaskSchedulerTest, BoundedRingQueue)
+{
+	// full and empty; the capacity is rounded up to the power of two
+	SGD::H1BoundedQueue<int32_t> ringQueue;
+	EXPECT_EQ(true, ringQueue.Initialize(6));
+	EXPECT_EQ(8u, ringQueue.GetCapacity());
+	int32_t element = -1;
+	EXPECT_EQ(false, ringQueue.TryDequeue(element));
+	// wrap around the ring several laps
+	for (int32_t lap = 0; lap < 3; ++lap)
+	{
+		for (int32_t i = 0; i < 8; ++i)
+			EXPECT_EQ(true, ringQueue.TryEnqueue(lap * 8 + i));
+		EXPECT_EQ(false, ringQueue.TryEnqueue(-1));
+		for (int32_t i = 0; i < 8; ++i)
+		{
+			EXPECT_EQ(true, ringQueue.TryDequeue(element));
+			EXPECT_EQ(lap * 8 + i, element);
+		}
+		EXPECT_EQ(false, ringQueue.TryDequeue(element));
+	}
+
+	// multiple producers & consumers with small ring; every element is dequeued exactly once
+	SGD::H1BoundedQueue<int32_t> stressQueue;
+	stressQueue.Initialize(64);
+	const int32_t producerCounts = 4;
+	const int32_t consumerCounts = 4;
+	const int32_t elementCountsPerProducer = 20000;
+	const int32_t totalElementCounts = producerCounts * elementCountsPerProducer;
+	std::vector<std::atomic<int32_t>> dequeuedCounts(totalElementCounts);
+	for (int32_t i = 0; i < totalElementCounts; ++i)
+		dequeuedCounts[i] = 0;
+
+	std::atomic<int32_t> totalDequeuedCounts(0);
+	std::vector<std::thread> threads;
+	for (int32_t producer = 0; producer < producerCounts; ++producer)
+	{
+		threads.emplace_back([&, producer]()
+		{
+			for (int32_t i = 0; i < elementCountsPerProducer; ++i)
+			{
+				while (!stressQueue.TryEnqueue(producer * elementCountsPerProducer + i))
+					std::this_thread::yield();
+			}
+		});
+	}
+	for (int32_t consumer = 0; consumer < consumerCounts; ++consumer)
+	{
+		threads.emplace_back([&]()
+		{
+			int32_t dequeuedElements[16];
+			while (totalDequeuedCounts.load() < totalElementCounts)
+			{
+				int32_t counts = stressQueue.TryDequeueBulk(dequeuedElements, 16);
+				if (counts == 0)
+					std::this_thread::yield();
+				for (int32_t i = 0; i < counts; ++i)
+					dequeuedCounts[dequeuedElements[i]]++;
+				totalDequeuedCounts += counts;
+			}
+		});
+	}
+	for (std::thread& rThread : threads)
+		rThread.join();
+
+	for (int32_t i = 0; i < totalElementCounts; ++i)
+		EXPECT_EQ(1, dequeuedCounts[i].load());
+	EXPECT_EQ(false, stressQueue.TryDequeue(element));
+}
+
+struct FiberMutexTestData
+{
+	SGD::H1FiberMutex* mutex;
+	int32_t* sharedCounts;
+	std::atomic<int32_t>* childCounts;
+};
+
+START_TASK_ENTRY_POINT(FiberMutexIncrement)
+{
+	FiberMutexTestData* pData = reinterpret_cast<FiberMutexTestData*>(pTaskData_FiberMutexIncrement);
+	for (int32_t i = 0; i < 200; ++i)
+	{
+		SGD::H1FiberMutexScope lockScope(*pData->mutex);
+		int32_t counts = *pData->sharedCounts;
+		// the holder suspends in the critical section; the contenders on the same worker thread must not block it
+		if (i % 50 == 0)
+		{
+			SGD::H1TaskDeclaration childTask(TaskEntryPoint_IncrementCounts, pData->childCounts);
+			SGD::H1TaskCounter* counter = nullptr;
+			SGD::H1TaskSchedulerLayer::RunTasks(&childTask, 1, &counter);
+			SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		}
+		*pData->sharedCounts = counts + 1;
+	}
+}
+
+TEST_F(TaskSchedulerTest, FiberMutex)
+{
+	SGD::H1FiberMutex mutex;
+	EXPECT_EQ(true, mutex.TryLock());
+	EXPECT_EQ(false, mutex.TryLock());
+	mutex.Unlock();
+
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	int32_t sharedCounts = 0;
+	std::atomic<int32_t> childCounts(0);
+	FiberMutexTestData taskData = { &mutex, &sharedCounts, &childCounts };
+	SGD::H1TaskDeclaration tasks[32];
+	for (int32_t i = 0; i < 32; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_FiberMutexIncrement);
+		tasks[i].SetTaskData(&taskData);
+	}
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 32, &counter);
+	// main thread contends too (spins instead of suspending)
+	for (int32_t i = 0; i < 100; ++i)
+	{
+		SGD::H1FiberMutexScope lockScope(mutex);
+		++sharedCounts;
+	}
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+
+	EXPECT_EQ(32 * 200 + 100, sharedCounts);
+	EXPECT_EQ(32 * 4, childCounts.load());
+	EXPECT_EQ(true, mutex.TryLock());
+	mutex.Unlock();
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct SemaphorePipelineData
+{
+	// bounded buffer guarded by the semaphores (free/filled slots) and the mutex
+	SGD::H1FiberSemaphore freeSlots;
+	SGD::H1FiberSemaphore filledSlots;
+	SGD::H1FiberMutex mutex;
+	int32_t buffer[8];
+	int32_t readIndex;
+	int32_t writeIndex;
+	std::atomic<int64_t> consumedSum;
+
+	// consumers wait for the start signal with the condition variable
+	SGD::H1FiberConditionVariable startCondition;
+	bool bStarted;
+	std::atomic<int32_t> startedConsumerCounts;
+
+	SemaphorePipelineData() : freeSlots(8), filledSlots(0), readIndex(0), writeIndex(0), consumedSum(0), bStarted(false), startedConsumerCounts(0) {}
+};
+
+START_TASK_ENTRY_POINT(SemaphoreProducer)
+{
+	SemaphorePipelineData* pData = reinterpret_cast<SemaphorePipelineData*>(pTaskData_SemaphoreProducer);
+	for (int32_t i = 1; i <= 500; ++i)
+	{
+		pData->freeSlots.Acquire();
+		{
+			SGD::H1FiberMutexScope lockScope(pData->mutex);
+			pData->buffer[pData->writeIndex] = i;
+			pData->writeIndex = (pData->writeIndex + 1) % 8;
+		}
+		pData->filledSlots.Release();
+	}
+}
+
+START_TASK_ENTRY_POINT(SemaphoreConsumer)
+{
+	SemaphorePipelineData* pData = reinterpret_cast<SemaphorePipelineData*>(pTaskData_SemaphoreConsumer);
+	{
+		SGD::H1FiberMutexScope lockScope(pData->mutex);
+		pData->startCondition.Wait(pData->mutex, [pData]() { return pData->bStarted; });
+	}
+	pData->startedConsumerCounts++;
+
+	for (int32_t i = 0; i < 500; ++i)
+	{
+		pData->filledSlots.Acquire();
+		int32_t value = 0;
+		{
+			SGD::H1FiberMutexScope lockScope(pData->mutex);
+			value = pData->buffer[pData->readIndex];
+			pData->readIndex = (pData->readIndex + 1) % 8;
+		}
+		pData->freeSlots.Release();
+		pData->consumedSum += value;
+	}
+}
+
+TEST_F(TaskSchedulerTest, FiberSemaphoreAndConditionVariable)
+{
+	SGD::H1FiberSemaphore semaphore(2);
+	EXPECT_EQ(true, semaphore.TryAcquire());
+	EXPECT_EQ(true, semaphore.TryAcquire());
+	EXPECT_EQ(false, semaphore.TryAcquire());
+	semaphore.Release(2);
+	EXPECT_EQ(2, semaphore.GetCounts());
+
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// 4 producers & 4 consumers streaming through 8 slots
+	SemaphorePipelineData data;
+	SGD::H1TaskDeclaration tasks[8];
+	for (int32_t i = 0; i < 8; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(i < 4 ? TaskEntryPoint_SemaphoreConsumer : TaskEntryPoint_SemaphoreProducer);
+		tasks[i].SetTaskData(&data);
+	}
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 8, &counter);
+
+	// consumers are parked on the condition variable until the start signal
+	EXPECT_EQ(0, data.startedConsumerCounts.load());
+	{
+		SGD::H1FiberMutexScope lockScope(data.mutex);
+		data.bStarted = true;
+	}
+	data.startCondition.NotifyAll();
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+
+	EXPECT_EQ(4, data.startedConsumerCounts.load());
+	EXPECT_EQ(4 * (500 * 501 / 2), data.consumedSum.load());
+	EXPECT_EQ(8, data.freeSlots.GetCounts());
+	EXPECT_EQ(0, data.filledSlots.GetCounts());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct ReaderWriterLockTestData
+{
+	SGD::H1FiberReaderWriterLock lock;
+	int32_t values[16];
+	std::atomic<int32_t> tornReadCounts;
+	std::atomic<int32_t> childCounts;
+
+	ReaderWriterLockTestData() : tornReadCounts(0), childCounts(0) { memset(values, 0, sizeof(values)); }
+};
+
+START_TASK_ENTRY_POINT(ReaderWriterLockReader)
+{
+	ReaderWriterLockTestData* pData = reinterpret_cast<ReaderWriterLockTestData*>(pTaskData_ReaderWriterLockReader);
+	for (int32_t i = 0; i < 200; ++i)
+	{
+		SGD::H1FiberReadScope readScope(pData->lock);
+		int32_t firstValue = pData->values[0];
+		// the reader could be resumed in other worker thread while it holds the lock
+		if (i % 50 == 0)
+		{
+			SGD::H1TaskDeclaration childTask(TaskEntryPoint_IncrementCounts, &pData->childCounts);
+			SGD::H1TaskCounter* counter = nullptr;
+			SGD::H1TaskSchedulerLayer::RunTasks(&childTask, 1, &counter);
+			SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		}
+		for (int32_t j = 1; j < 16; ++j)
+		{
+			if (pData->values[j] != firstValue)
+				pData->tornReadCounts++;
+		}
+	}
+}
+
+START_TASK_ENTRY_POINT(ReaderWriterLockWriter)
+{
+	ReaderWriterLockTestData* pData = reinterpret_cast<ReaderWriterLockTestData*>(pTaskData_ReaderWriterLockWriter);
+	for (int32_t i = 0; i < 50; ++i)
+	{
+		SGD::H1FiberWriteScope writeScope(pData->lock);
+		for (int32_t j = 0; j < 16; ++j)
+			pData->values[j]++;
+	}
+}
+
+TEST_F(TaskSchedulerTest, FiberReaderWriterLock)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// 24 readers & 4 writers; readers never see the half-written values
+	ReaderWriterLockTestData data;
+	SGD::H1TaskDeclaration tasks[28];
+	for (int32_t i = 0; i < 28; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(i % 7 == 0 ? TaskEntryPoint_ReaderWriterLockWriter : TaskEntryPoint_ReaderWriterLockReader);
+		tasks[i].SetTaskData(&data);
+	}
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 28, &counter);
+	// main thread reads too
+	for (int32_t i = 0; i < 100; ++i)
+	{
+		SGD::H1FiberReadScope readScope(data.lock);
+		for (int32_t j = 1; j < 16; ++j)
+		{
+			if (data.values[j] != data.values[0])
+				data.tornReadCounts++;
+		}
+	}
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+
+	EXPECT_EQ(0, data.tornReadCounts.load());
+	EXPECT_EQ(24 * 4, data.childCounts.load());
+	for (int32_t j = 0; j < 16; ++j)
+		EXPECT_EQ(4 * 50, data.values[j]);
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct FiberBarrierTestData
+{
+	SGD::H1FiberBarrier* barrier;
+	int32_t phaseValues[8];
+	std::atomic<int32_t> lastArriverCounts;
+	std::atomic<int32_t> mismatchCounts;
+	std::atomic<int32_t> participantIndex;
+};
+
+START_TASK_ENTRY_POINT(FiberBarrierPhases)
+{
+	FiberBarrierTestData* pData = reinterpret_cast<FiberBarrierTestData*>(pTaskData_FiberBarrierPhases);
+	int32_t index = pData->participantIndex++;
+	for (int32_t phase = 1; phase <= 5; ++phase)
+	{
+		pData->phaseValues[index] = phase;
+		if (pData->barrier->ArriveAndWait())
+			pData->lastArriverCounts++;
+
+		// all participants reached this phase before anyone continues
+		for (int32_t i = 0; i < 8; ++i)
+		{
+			if (pData->phaseValues[i] < phase)
+				pData->mismatchCounts++;
+		}
+		// nobody starts writing the next phase until everyone checked this phase
+		pData->barrier->ArriveAndWait();
+	}
+}
+
+START_TASK_ENTRY_POINT(CountDownLatch)
+{
+	SGD::H1FiberLatch* pLatch = reinterpret_cast<SGD::H1FiberLatch*>(pTaskData_CountDownLatch);
+	pLatch->CountDown();
+}
+
+START_TASK_ENTRY_POINT(WaitForStackLatch)
+{
+	std::atomic<int32_t>* pWaitedCounts = reinterpret_cast<std::atomic<int32_t>*>(pTaskData_WaitForStackLatch);
+
+	// the latch lives on the fiber stack; it is destroyed right after Wait
+	SGD::H1FiberLatch latch(8);
+	for (int32_t i = 0; i < 8; ++i)
+		SGD::H1TaskSchedulerLayer::SpawnTask(TaskEntryPoint_CountDownLatch, &latch);
+	latch.Wait();
+	(*pWaitedCounts)++;
+}
+
+TEST_F(TaskSchedulerTest, FiberBarrierAndLatch)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// barrier reused over the phases
+	SGD::H1FiberBarrier barrier(8);
+	FiberBarrierTestData barrierData;
+	barrierData.barrier = &barrier;
+	memset(barrierData.phaseValues, 0, sizeof(barrierData.phaseValues));
+	barrierData.lastArriverCounts = 0;
+	barrierData.mismatchCounts = 0;
+	barrierData.participantIndex = 0;
+	SGD::H1TaskDeclaration barrierTasks[8];
+	for (int32_t i = 0; i < 8; ++i)
+	{
+		barrierTasks[i].SetTaskEntryPoint(TaskEntryPoint_FiberBarrierPhases);
+		barrierTasks[i].SetTaskData(&barrierData);
+	}
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(barrierTasks, 8, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	EXPECT_EQ(5, barrierData.lastArriverCounts.load());
+	EXPECT_EQ(0, barrierData.mismatchCounts.load());
+	EXPECT_EQ(10u, barrier.GetPhase());
+
+	// latches on the fiber stacks
+	std::atomic<int32_t> waitedCounts(0);
+	SGD::H1TaskDeclaration latchTasks[8];
+	for (int32_t i = 0; i < 8; ++i)
+	{
+		latchTasks[i].SetTaskEntryPoint(TaskEntryPoint_WaitForStackLatch);
+		latchTasks[i].SetTaskData(&waitedCounts);
+	}
+	SGD::H1TaskSchedulerLayer::RunTasks(latchTasks, 8, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	EXPECT_EQ(8, waitedCounts.load());
+
+	// latch waited by main thread
+	SGD::H1FiberLatch latch(16);
+	EXPECT_EQ(false, latch.TryWait());
+	for (int32_t i = 0; i < 16; ++i)
+		SGD::H1TaskSchedulerLayer::SpawnTask(TaskEntryPoint_CountDownLatch, &latch);
+	latch.Wait();
+	EXPECT_EQ(true, latch.TryWait());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct FiberChannelTestData
+{
+	SGD::H1FiberChannel<int32_t>* channel;
+	std::atomic<int32_t> producerIndex;
+	std::atomic<int64_t> receivedSum;
+	std::atomic<int32_t> receivedCounts;
+	std::atomic<int32_t> failedSendCounts;
+};
+
+START_TASK_ENTRY_POINT(ChannelProducer)
+{
+	FiberChannelTestData* pData = reinterpret_cast<FiberChannelTestData*>(pTaskData_ChannelProducer);
+	int32_t base = (pData->producerIndex++) * 256;
+
+	// half one by one, half in batches (both suspend while the channel is full)
+	for (int32_t i = 0; i < 128; ++i)
+	{
+		if (!pData->channel->Send(base + i))
+			pData->failedSendCounts++;
+	}
+	int32_t values[16];
+	for (int32_t i = 128; i < 256; i += 16)
+	{
+		for (int32_t j = 0; j < 16; ++j)
+			values[j] = base + i + j;
+		if (pData->channel->SendBatch(values, 16) != 16)
+			pData->failedSendCounts++;
+	}
+}
+
+START_TASK_ENTRY_POINT(ChannelConsumer)
+{
+	FiberChannelTestData* pData = reinterpret_cast<FiberChannelTestData*>(pTaskData_ChannelConsumer);
+
+	// receive until the channel is closed and drained
+	int32_t values[8];
+	uint32_t receivedCounts = 0;
+	while ((receivedCounts = pData->channel->RecvBatch(values, 8)) > 0)
+	{
+		for (uint32_t i = 0; i < receivedCounts; ++i)
+			pData->receivedSum += values[i];
+		pData->receivedCounts += receivedCounts;
+	}
+}
+
+TEST_F(TaskSchedulerTest, FiberChannel)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// small capacity to exercise the back-pressure
+	SGD::H1FiberChannel<int32_t> channel(4);
+	FiberChannelTestData data;
+	data.channel = &channel;
+	data.producerIndex = 0;
+	data.receivedSum = 0;
+	data.receivedCounts = 0;
+	data.failedSendCounts = 0;
+
+	SGD::H1TaskDeclaration consumerTasks[4];
+	SGD::H1TaskDeclaration producerTasks[4];
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		consumerTasks[i].SetTaskEntryPoint(TaskEntryPoint_ChannelConsumer);
+		consumerTasks[i].SetTaskData(&data);
+		producerTasks[i].SetTaskEntryPoint(TaskEntryPoint_ChannelProducer);
+		producerTasks[i].SetTaskData(&data);
+	}
+	SGD::H1TaskCounter* consumerCounter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(consumerTasks, 4, &consumerCounter);
+	// separated counter for the producers (the main thread counter is shared with the consumers)
+	SGD::H1TaskCounter producerCounter;
+	SGD::H1TaskSchedulerLayer::RunTasksWithCounter(producerTasks, 4, &producerCounter);
+
+	// close after all producers finished; the consumers drain the rest and quit
+	SGD::H1TaskSchedulerLayer::WaitForCounter(&producerCounter);
+	channel.Close();
+	SGD::H1TaskSchedulerLayer::WaitForCounter(consumerCounter);
+
+	const int32_t totalCounts = 4 * 256;
+	EXPECT_EQ(0, data.failedSendCounts.load());
+	EXPECT_EQ(totalCounts, data.receivedCounts.load());
+	EXPECT_EQ(int64_t(totalCounts) * (totalCounts - 1) / 2, data.receivedSum.load());
+
+	// closed channel fails the senders; the receivers drain the buffered elements first
+	SGD::H1FiberChannel<int32_t> closedChannel(2);
+	EXPECT_EQ(true, closedChannel.TrySend(1));
+	EXPECT_EQ(true, closedChannel.TrySend(2));
+	EXPECT_EQ(false, closedChannel.TrySend(3));
+	closedChannel.Close();
+	EXPECT_EQ(false, closedChannel.Send(4));
+	int32_t value = 0;
+	EXPECT_EQ(true, closedChannel.Recv(value));
+	EXPECT_EQ(1, value);
+	EXPECT_EQ(true, closedChannel.TryRecv(value));
+	EXPECT_EQ(2, value);
+	EXPECT_EQ(false, closedChannel.Recv(value));
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct FiberLocalTestData
+{
+	SGD::FiberLocalSlot slot;
+	std::atomic<int32_t> leakedCounts;
+	std::atomic<int32_t> mismatchCounts;
+	std::atomic<int32_t> cleanupCounts;
+};
+
+FiberLocalTestData* gFiberLocalTestData = nullptr;
+
+void FiberLocalCleanupCounts(void* value)
+{
+	gFiberLocalTestData->cleanupCounts++;
+}
+
+START_TASK_ENTRY_POINT(FiberLocalValue)
+{
+	FiberLocalTestData* pData = reinterpret_cast<FiberLocalTestData*>(pTaskData_FiberLocalValue);
+
+	// the value set by the previous task of the recycled fiber is reset
+	if (SGD::H1TaskSchedulerLayer::GetFiberLocalValue(pData->slot) != nullptr)
+		pData->leakedCounts++;
+
+	int32_t localValue = 0;
+	SGD::H1TaskSchedulerLayer::SetFiberLocalValue(pData->slot, &localValue);
+
+	// the fiber could be resumed by another worker thread after waiting
+	std::atomic<int32_t> counts(0);
+	SGD::H1TaskDeclaration tasks[4];
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_IncrementCounts);
+		tasks[i].SetTaskData(&counts);
+	}
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 4, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+
+	if (SGD::H1TaskSchedulerLayer::GetFiberLocalValue(pData->slot) != &localValue)
+		pData->mismatchCounts++;
+}
+
+TEST_F(TaskSchedulerTest, FiberLocalStorage)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	FiberLocalTestData data;
+	data.leakedCounts = 0;
+	data.mismatchCounts = 0;
+	data.cleanupCounts = 0;
+	gFiberLocalTestData = &data;
+	data.slot = SGD::H1TaskSchedulerLayer::AllocateFiberLocalSlot(FiberLocalCleanupCounts);
+	const SGD::FiberLocalSlot invalidSlot = SGD::H1FiberContext::InvalidLocalSlot;
+	ASSERT_NE(invalidSlot, data.slot);
+
+	// main thread has no fiber-local storage
+	EXPECT_EQ(nullptr, SGD::H1TaskSchedulerLayer::GetFiberLocalValue(data.slot));
+	EXPECT_EQ(false, SGD::H1TaskSchedulerLayer::SetFiberLocalValue(data.slot, &data));
+
+	// more tasks than the fiber contexts so the fibers are recycled
+	const int32_t taskCounts = 256;
+	SGD::H1TaskCounter* counter = nullptr;
+	for (int32_t batch = 0; batch < 4; ++batch)
+	{
+		SGD::H1TaskDeclaration tasks[taskCounts / 4];
+		for (int32_t i = 0; i < taskCounts / 4; ++i)
+		{
+			tasks[i].SetTaskEntryPoint(TaskEntryPoint_FiberLocalValue);
+			tasks[i].SetTaskData(&data);
+		}
+		SGD::H1TaskSchedulerLayer::RunTasks(tasks, taskCounts / 4, &counter);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	}
+	EXPECT_EQ(0, data.leakedCounts.load());
+	EXPECT_EQ(0, data.mismatchCounts.load());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+
+	// every value is cleaned up when its fiber returned to the pool
+	EXPECT_EQ(taskCounts, data.cleanupCounts.load());
+	SGD::H1TaskSchedulerLayer::FreeFiberLocalSlot(data.slot);
+	gFiberLocalTestData = nullptr;
+
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct TimerWheelTestTimer
+{
+	uint64_t expireTimestamp;
+	uint64_t firedTimestamp;
+	int32_t firedCounts;
+};
+
+// timestamp passed to the last H1TimerWheel::Advance
+uint64_t gTimerWheelTestNow = 0;
+
+void TimerWheelTestExpire(void* pData)
+{
+	TimerWheelTestTimer* pTimer = reinterpret_cast<TimerWheelTestTimer*>(pData);
+	pTimer->firedTimestamp = gTimerWheelTestNow;
+	pTimer->firedCounts++;
+}
+
+struct FiberSleepTestData
+{
+	uint32_t sleepMicroseconds;
+	std::atomic<int32_t> earlyWakeCounts;
+};
+
+START_TASK_ENTRY_POINT(FiberSleep)
+{
+	FiberSleepTestData* pData = reinterpret_cast<FiberSleepTestData*>(pTaskData_FiberSleep);
+	uint64_t deadline = SGD::H1TaskSchedulerLayer::GetDeadlineAfter(pData->sleepMicroseconds);
+	SGD::H1TaskSchedulerLayer::SleepFor(pData->sleepMicroseconds);
+	if (SGD::appGetTimestamp() < deadline)
+		pData->earlyWakeCounts++;
+}
+
+TEST_F(TaskSchedulerTest, FiberSleepAndTimerWheel)
+{
+	// timer wheel driven by the synthetic timestamps (near, level boundaries, cascaded and beyond the top level)
+	SGD::H1TimerWheel timerWheel;
+	timerWheel.Initialize();
+	const uint64_t tick = timerWheel.GetTickTimestamps();
+	const uint64_t baseTimestamp = SGD::appGetTimestamp();
+	const uint64_t delayTicks[] = { 0, 1, 5, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 300000, 20000000 };
+	const int32_t delayCounts = sizeof(delayTicks) / sizeof(delayTicks[0]);
+	const int32_t timerCounts = delayCounts * 6;
+
+	std::vector<TimerWheelTestTimer> timers(timerCounts);
+	std::vector<SGD::H1TimerNode> timerNodes(timerCounts);
+	for (int32_t i = 0; i < timerCounts; ++i)
+	{
+		timers[i].expireTimestamp = baseTimestamp + delayTicks[i % delayCounts] * tick + (i / delayCounts) * (tick / 3);
+		timers[i].firedTimestamp = 0;
+		timers[i].firedCounts = 0;
+		timerNodes[i].Callback = TimerWheelTestExpire;
+		timerNodes[i].Data = &timers[i];
+		timerWheel.Insert(&timerNodes[i], timers[i].expireTimestamp);
+	}
+
+	// cancel every third timer
+	for (int32_t i = 0; i < timerCounts; i += 3)
+	{
+		EXPECT_EQ(true, timerWheel.Cancel(&timerNodes[i]));
+		EXPECT_EQ(false, timerWheel.Cancel(&timerNodes[i]));
+	}
+
+	const uint64_t stepTimestamps = tick * 37 + 1;
+	// the farthest expiration plus the offset and the rounding up
+	const uint64_t endTimestamp = baseTimestamp + (delayTicks[delayCounts - 1] + 4) * tick;
+	int32_t expiredCounts = 0;
+	for (gTimerWheelTestNow = baseTimestamp; gTimerWheelTestNow < endTimestamp; gTimerWheelTestNow += stepTimestamps)
+		expiredCounts += timerWheel.Advance(gTimerWheelTestNow);
+	gTimerWheelTestNow = endTimestamp;
+	expiredCounts += timerWheel.Advance(gTimerWheelTestNow);
+	EXPECT_EQ(true, timerWheel.IsEmpty());
+
+	int32_t cancelledCounts = 0;
+	for (int32_t i = 0; i < timerCounts; ++i)
+	{
+		if (i % 3 == 0)
+		{
+			EXPECT_EQ(0, timers[i].firedCounts);
+			++cancelledCounts;
+			continue;
+		}
+
+		// never earlier than the expiration, and no later than one step (plus the rounding tick)
+		EXPECT_EQ(1, timers[i].firedCounts);
+		EXPECT_LE(timers[i].expireTimestamp, timers[i].firedTimestamp);
+		EXPECT_GT(timers[i].expireTimestamp + stepTimestamps + tick, timers[i].firedTimestamp);
+	}
+	EXPECT_EQ(timerCounts - cancelledCounts, expiredCounts);
+	timerWheel.Destroy();
+
+	// the empty wheel is not advanced; the insert after the idle gap catches up current tick
+	SGD::H1TimerWheel idleTimerWheel;
+	idleTimerWheel.Initialize();
+	SGD::appSleep(20);
+	const uint64_t idleEndTimestamp = SGD::appGetTimestamp();
+	SGD::H1TimerNode idleTimerNode;
+	idleTimerNode.Callback = TimerWheelTestExpire;
+	TimerWheelTestTimer idleTimer;
+	idleTimer.firedCounts = 0;
+	idleTimerNode.Data = &idleTimer;
+	idleTimerWheel.Insert(&idleTimerNode, idleEndTimestamp + tick);
+	EXPECT_LE(idleEndTimestamp / tick, idleTimerWheel.GetCurrentTick());
+	gTimerWheelTestNow = idleEndTimestamp + 2 * tick;
+	EXPECT_EQ(1, idleTimerWheel.Advance(gTimerWheelTestNow));
+	EXPECT_EQ(1, idleTimer.firedCounts);
+	idleTimerWheel.Destroy();
+
+	// sleeping fibers don't block the worker threads
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	FiberSleepTestData sleepData;
+	sleepData.sleepMicroseconds = 2000;
+	sleepData.earlyWakeCounts = 0;
+	const int32_t sleepTaskCounts = 32;
+	SGD::H1TaskDeclaration sleepTasks[sleepTaskCounts];
+	for (int32_t i = 0; i < sleepTaskCounts; ++i)
+	{
+		sleepTasks[i].SetTaskEntryPoint(TaskEntryPoint_FiberSleep);
+		sleepTasks[i].SetTaskData(&sleepData);
+	}
+	uint64_t sleepBeginTimestamp = SGD::appGetTimestamp();
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(sleepTasks, sleepTaskCounts, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	uint64_t sleepElapsed = SGD::appGetTimestamp() - sleepBeginTimestamp;
+	EXPECT_EQ(0, sleepData.earlyWakeCounts.load());
+	// the fibers slept together (far less than sleeping one after another)
+	EXPECT_GT(SGD::H1TaskSchedulerLayer::GetDeadlineAfter(sleepData.sleepMicroseconds * sleepTaskCounts / 2) - SGD::appGetTimestamp(), sleepElapsed);
+
+	// the fibers sleeping after the idle gap wake up in time
+	SGD::appSleep(20);
+	sleepBeginTimestamp = SGD::appGetTimestamp();
+	SGD::H1TaskSchedulerLayer::RunTasks(sleepTasks, sleepTaskCounts, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	sleepElapsed = SGD::appGetTimestamp() - sleepBeginTimestamp;
+	EXPECT_EQ(0, sleepData.earlyWakeCounts.load());
+	EXPECT_GT(SGD::H1TaskSchedulerLayer::GetDeadlineAfter(sleepData.sleepMicroseconds * sleepTaskCounts / 2) - SGD::appGetTimestamp(), sleepElapsed);
+
+	// main thread blocks instead
+	uint64_t mainDeadline = SGD::H1TaskSchedulerLayer::GetDeadlineAfter(1000);
+	SGD::H1TaskSchedulerLayer::SleepUntil(mainDeadline);
+	EXPECT_LE(mainDeadline, SGD::appGetTimestamp());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct OffloadTestData
+{
+	std::atomic<int32_t> completedCounts;
+	std::atomic<int32_t> workerThreadCallCounts;
+	std::atomic<int32_t> mismatchCounts;
+};
+
+void BlockingSleepCall(void* pData)
+{
+	OffloadTestData* pOffloadData = reinterpret_cast<OffloadTestData*>(pData);
+	// the blocking call never runs in the worker thread
+	if (SGD::H1WorkerThread::GetCurrentWorkerThread() != nullptr)
+		pOffloadData->workerThreadCallCounts++;
+	SGD::appSleep(5);
+	pOffloadData->completedCounts++;
+}
+
+START_TASK_ENTRY_POINT(OffloadBlockingCall)
+{
+	OffloadTestData* pData = reinterpret_cast<OffloadTestData*>(pTaskData_OffloadBlockingCall);
+	int32_t completedCounts = pData->completedCounts.load();
+	SGD::H1TaskSchedulerLayer::RunBlockingCall(BlockingSleepCall, pData);
+	// the fiber is resumed after the call completed
+	if (pData->completedCounts.load() <= completedCounts)
+		pData->mismatchCounts++;
+}
+
+TEST_F(TaskSchedulerTest, OffloadBlockingCalls)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+	SGD::H1OffloadPool& rOffloadPool = SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetOffloadPool();
+
+	OffloadTestData data;
+	data.completedCounts = 0;
+	data.workerThreadCallCounts = 0;
+	data.mismatchCounts = 0;
+
+	// the blocking calls overlap in the offload threads (far less than running one after another)
+	const int32_t taskCounts = 16;
+	SGD::H1TaskDeclaration tasks[taskCounts];
+	for (int32_t i = 0; i < taskCounts; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_OffloadBlockingCall);
+		tasks[i].SetTaskData(&data);
+	}
+	uint64_t beginTimestamp = SGD::appGetTimestamp();
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, taskCounts, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	uint64_t elapsed = SGD::appGetTimestamp() - beginTimestamp;
+	EXPECT_EQ(taskCounts, data.completedCounts.load());
+	EXPECT_EQ(0, data.workerThreadCallCounts.load());
+	EXPECT_EQ(0, data.mismatchCounts.load());
+	EXPECT_GT(SGD::H1TaskSchedulerLayer::GetDeadlineAfter(5000 * taskCounts / 2) - SGD::appGetTimestamp(), elapsed);
+
+	// main thread waits without the fiber
+	int32_t callableCounts = 0;
+	auto callable = [&callableCounts]() { SGD::appSleep(1); ++callableCounts; };
+	rOffloadPool.RunCallable(callable);
+	EXPECT_EQ(1, callableCounts);
+
+	SGD::H1OffloadMetrics metrics = rOffloadPool.GetMetrics();
+	EXPECT_EQ(uint64_t(taskCounts + 1), metrics.CompletedCounts);
+	EXPECT_EQ(0u, metrics.QueueDepth);
+	EXPECT_LT(1u, metrics.MaxThreadCounts);
+	EXPECT_LE(metrics.MaxQueueLatency, metrics.MaxLatency);
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct ReactorTestData
+{
+	SGD::H1IODescriptor listener;
+	uint16_t port;
+	int32_t connectionCounts;
+	SGD::H1IODescriptor connections[4];
+	SGD::H1TaskCounter connectionCounter;
+	std::atomic<int32_t> mismatchCounts;
+	std::atomic<int32_t> echoedBytes;
+};
+
+START_TASK_ENTRY_POINT(ReactorEchoConnection)
+{
+	SGD::H1IODescriptor* pConnection = reinterpret_cast<SGD::H1IODescriptor*>(pTaskData_ReactorEchoConnection);
+
+	// echo until the client closes the connection
+	uint8_t buffer[256];
+	int64_t bytes = 0;
+	while ((bytes = pConnection->Read(buffer, sizeof(buffer))) > 0)
+		pConnection->Write(buffer, size_t(bytes));
+	pConnection->Destroy();
+}
+
+START_TASK_ENTRY_POINT(ReactorAcceptConnections)
+{
+	ReactorTestData* pData = reinterpret_cast<ReactorTestData*>(pTaskData_ReactorAcceptConnections);
+	SGD::H1Reactor* pReactor = &SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetReactor();
+	for (int32_t i = 0; i < pData->connectionCounts; ++i)
+	{
+		SGD::IOHandle handle = pData->listener.Accept();
+		if (handle == SGD::InvalidIOHandle || !pData->connections[i].Initialize(handle, pReactor))
+		{
+			// close the accepted handle and the listener; the clients waiting for the echo fail instead of blocking forever
+			if (handle != SGD::InvalidIOHandle)
+				SGD::H1IODescriptor::CloseIOHandle(handle);
+			pData->listener.Destroy();
+			pData->mismatchCounts++;
+			return;
+		}
+		SGD::H1TaskSchedulerLayer::SpawnTask(TaskEntryPoint_ReactorEchoConnection, &pData->connections[i], &pData->connectionCounter);
+	}
+}
+
+START_TASK_ENTRY_POINT(ReactorEchoClient)
+{
+	ReactorTestData* pData = reinterpret_cast<ReactorTestData*>(pTaskData_ReactorEchoClient);
+	SGD::H1IODescriptor client;
+	if (!client.Initialize(SGD::H1IODescriptor::CreateSocket(), &SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetReactor())
+		|| !client.ConnectLoopback(pData->port))
+	{
+		pData->mismatchCounts++;
+		client.Destroy();
+		return;
+	}
+
+	// request-response round trips
+	uint8_t request[64];
+	uint8_t response[64];
+	for (int32_t round = 0; round < 100; ++round)
+	{
+		for (int32_t i = 0; i < 64; ++i)
+			request[i] = uint8_t(round + i);
+		if (client.Write(request, sizeof(request)) != sizeof(request) || !client.ReadExactly(response, sizeof(response)) || memcmp(request, response, sizeof(request)) != 0)
+		{
+			pData->mismatchCounts++;
+			break;
+		}
+		pData->echoedBytes += sizeof(response);
+	}
+	client.Destroy();
+}
+
+struct ReactorPipeTestData
+{
+	SGD::H1IODescriptor reader;
+	SGD::H1IODescriptor writer;
+	std::atomic<int32_t> mismatchCounts;
+};
+
+const int32_t ReactorPipeBytes = 1 << 20;
+
+START_TASK_ENTRY_POINT(ReactorPipeWriter)
+{
+	ReactorPipeTestData* pData = reinterpret_cast<ReactorPipeTestData*>(pTaskData_ReactorPipeWriter);
+	// larger than the pipe buffer; the writer is parked while the pipe is full
+	std::vector<uint8_t> bytes(ReactorPipeBytes);
+	for (int32_t i = 0; i < ReactorPipeBytes; ++i)
+		bytes[i] = uint8_t(i * 7);
+	if (pData->writer.Write(bytes.data(), bytes.size()) != ReactorPipeBytes)
+		pData->mismatchCounts++;
+	pData->writer.Destroy();
+}
+
+START_TASK_ENTRY_POINT(ReactorPipeReader)
+{
+	ReactorPipeTestData* pData = reinterpret_cast<ReactorPipeTestData*>(pTaskData_ReactorPipeReader);
+	uint8_t buffer[4096];
+	int32_t readBytes = 0;
+	int64_t bytes = 0;
+	while ((bytes = pData->reader.Read(buffer, sizeof(buffer))) > 0)
+	{
+		for (int64_t i = 0; i < bytes; ++i)
+		{
+			if (buffer[i] != uint8_t((readBytes + i) * 7))
+				pData->mismatchCounts++;
+		}
+		readBytes += int32_t(bytes);
+	}
+	if (readBytes != ReactorPipeBytes)
+		pData->mismatchCounts++;
+	pData->reader.Destroy();
+}
+
+TEST_F(TaskSchedulerTest, ReactorSocketAndPipeIO)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+	SGD::H1Reactor* pReactor = &SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetReactor();
+
+	// echo server and clients over the loopback in the fibers
+	ReactorTestData data;
+	data.port = 0;
+	data.connectionCounts = 4;
+	data.mismatchCounts = 0;
+	data.echoedBytes = 0;
+	ASSERT_EQ(true, data.listener.Initialize(SGD::H1IODescriptor::CreateLoopbackListener(data.port), pReactor));
+	EXPECT_NE(0, data.port);
+
+	SGD::H1TaskDeclaration tasks[5];
+	tasks[0].SetTaskEntryPoint(TaskEntryPoint_ReactorAcceptConnections);
+	tasks[0].SetTaskData(&data);
+	for (int32_t i = 1; i < 5; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_ReactorEchoClient);
+		tasks[i].SetTaskData(&data);
+	}
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 5, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(&data.connectionCounter);
+	data.listener.Destroy();
+	EXPECT_EQ(0, data.mismatchCounts.load());
+	EXPECT_EQ(4 * 100 * 64, data.echoedBytes.load());
+	EXPECT_EQ(true, pReactor->IsEmpty());
+
+	// pipe with the reader and the writer parked alternately
+	ReactorPipeTestData pipeData;
+	pipeData.mismatchCounts = 0;
+	SGD::IOHandle readHandle = SGD::InvalidIOHandle;
+	SGD::IOHandle writeHandle = SGD::InvalidIOHandle;
+	ASSERT_EQ(true, SGD::H1IODescriptor::CreatePipe(readHandle, writeHandle));
+	ASSERT_EQ(true, pipeData.reader.Initialize(readHandle, pReactor));
+	ASSERT_EQ(true, pipeData.writer.Initialize(writeHandle, pReactor));
+
+	SGD::H1TaskDeclaration pipeTasks[2];
+	pipeTasks[0].SetTaskEntryPoint(TaskEntryPoint_ReactorPipeReader);
+	pipeTasks[0].SetTaskData(&pipeData);
+	pipeTasks[1].SetTaskEntryPoint(TaskEntryPoint_ReactorPipeWriter);
+	pipeTasks[1].SetTaskData(&pipeData);
+	SGD::H1TaskSchedulerLayer::RunTasks(pipeTasks, 2, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	EXPECT_EQ(0, pipeData.mismatchCounts.load());
+	EXPECT_EQ(true, pReactor->IsEmpty());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+struct AsyncFileTestData
+{
+	SGD::FileHandle handle;
+	std::atomic<int32_t> mismatchCounts;
+};
+
+const int32_t AsyncFileBlockSize = 4096;
+const int32_t AsyncFileBlockCounts = 16;
+
+START_TASK_ENTRY_POINT(AsyncFileWriteAndRead)
+{
+	AsyncFileTestData* pData = reinterpret_cast<AsyncFileTestData*>(pTaskData_AsyncFileWriteAndRead);
+	SGD::H1AsyncFileIO& asyncFileIO = SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetAsyncFileIO();
+
+	// each block is filled with its index
+	std::vector<uint8_t> block(AsyncFileBlockSize);
+	for (int32_t i = 0; i < AsyncFileBlockCounts; ++i)
+	{
+		memset(block.data(), i, block.size());
+		if (asyncFileIO.Write(pData->handle, block.data(), block.size(), uint64_t(i) * AsyncFileBlockSize) != AsyncFileBlockSize)
+			pData->mismatchCounts++;
+	}
+	if (!asyncFileIO.Sync(pData->handle))
+		pData->mismatchCounts++;
+
+	// issue all reads at once and wait for them with one latch
+	std::vector<uint8_t> blocks(AsyncFileBlockSize * AsyncFileBlockCounts);
+	SGD::H1FileIORequest requests[AsyncFileBlockCounts];
+	SGD::H1FiberLatch latch(AsyncFileBlockCounts);
+	for (int32_t i = AsyncFileBlockCounts - 1; i >= 0; --i)
+	{
+		requests[i].Operation = SGD::EFIO_Read;
+		requests[i].Handle = pData->handle;
+		requests[i].Buffer = &blocks[i * AsyncFileBlockSize];
+		requests[i].Size = AsyncFileBlockSize;
+		requests[i].Offset = uint64_t(i) * AsyncFileBlockSize;
+		requests[i].Latch = &latch;
+		asyncFileIO.Submit(&requests[i]);
+	}
+	latch.Wait();
+	for (int32_t i = 0; i < AsyncFileBlockCounts; ++i)
+	{
+		if (requests[i].Result != AsyncFileBlockSize || blocks[i * AsyncFileBlockSize] != uint8_t(i) || blocks[(i + 1) * AsyncFileBlockSize - 1] != uint8_t(i))
+			pData->mismatchCounts++;
+	}
+
+	// scatter the last two blocks; the read at the end of the file is short
+	uint8_t head[100];
+	uint8_t tail[AsyncFileBlockSize * 2];
+	SGD::H1FileIOVector vectors[2] = { { head, sizeof(head) }, { tail, sizeof(tail) } };
+	uint64_t offset = uint64_t(AsyncFileBlockCounts - 2) * AsyncFileBlockSize;
+	if (asyncFileIO.ReadV(pData->handle, vectors, 2, offset) != AsyncFileBlockSize * 2)
+		pData->mismatchCounts++;
+	if (head[0] != uint8_t(AsyncFileBlockCounts - 2) || tail[AsyncFileBlockSize] != uint8_t(AsyncFileBlockCounts - 1))
+		pData->mismatchCounts++;
+
+	// end of the file, invalid handle
+	if (asyncFileIO.Read(pData->handle, block.data(), block.size(), uint64_t(AsyncFileBlockCounts) * AsyncFileBlockSize) != 0)
+		pData->mismatchCounts++;
+	if (asyncFileIO.Read(SGD::InvalidFileHandle, block.data(), block.size(), 0) != -1)
+		pData->mismatchCounts++;
+}
+
+TEST_F(TaskSchedulerTest, AsyncFileIO)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+	SGD::H1AsyncFileIO& asyncFileIO = SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetAsyncFileIO();
+
+	const char* path = "SGDAsyncFileIOTest.bin";
+	AsyncFileTestData data;
+	data.handle = SGD::H1AsyncFileIO::OpenFile(path, SGD::EFOM_ReadWrite);
+	data.mismatchCounts = 0;
+	ASSERT_NE(SGD::InvalidFileHandle, data.handle);
+
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskDeclaration tasks[4];
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_AsyncFileWriteAndRead);
+		tasks[i].SetTaskData(&data);
+	}
+	SGD::H1TaskSchedulerLayer::RunTasks(tasks, 4, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	EXPECT_EQ(0, data.mismatchCounts.load());
+
+	// the main thread is not the worker thread; it waits for the offload thread by spinning
+	uint8_t block[AsyncFileBlockSize];
+	EXPECT_EQ(AsyncFileBlockSize, asyncFileIO.Read(data.handle, block, sizeof(block), AsyncFileBlockSize * 3));
+	EXPECT_EQ(3, block[0]);
+
+	SGD::H1AsyncFileIO::CloseFile(data.handle);
+	std::remove(path);
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+TEST_F(TaskSchedulerTest, BatchedDequeuePrefersHigherPriority)
+{
+	// the worker threads are not started; dequeue on behalf of the first one
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskScheduler* pTaskScheduler = SGD::H1TaskSchedulerLayer::GetTaskScheduler();
+	SGD::H1WorkerThread* pWorkerThread = pTaskScheduler->GetWorkerThreadPool().GetWorkerThreadByIndex(0);
+	pTaskScheduler->SetTaskDequeueBatchSize(8);
+
+	// the low-priority tasks are buffered in batch
+	SGD::H1TaskDeclaration lowTasks[4];
+	pTaskScheduler->EnqueueTaskRange(lowTasks, 4, SGD::ETQP_Low);
+	EXPECT_EQ(&lowTasks[0], pTaskScheduler->DequeueTask(pWorkerThread));
+	EXPECT_EQ(false, pWorkerThread->GetLocalTaskBuffer().IsEmpty());
+
+	// new high-priority task doesn't wait behind the buffered tasks
+	SGD::H1TaskDeclaration highTask;
+	pTaskScheduler->EnqueueTask(&highTask, SGD::ETQP_High);
+	EXPECT_EQ(&highTask, pTaskScheduler->DequeueTask(pWorkerThread));
+	EXPECT_EQ(SGD::ETQP_High, highTask.GetQueuePriority());
+
+	for (int32_t i = 1; i < 4; ++i)
+		EXPECT_EQ(&lowTasks[i], pTaskScheduler->DequeueTask(pWorkerThread));
+	EXPECT_EQ(nullptr, pTaskScheduler->DequeueTask(pWorkerThread));
+	EXPECT_EQ(SGD::ETQP_Low, lowTasks[0].GetQueuePriority());
+
+	pTaskScheduler->SetTaskDequeueBatchSize(SGD::H1TaskScheduler::DefaultTaskDequeueBatchSize);
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+TEST_F(TaskSchedulerTest, BufferedTasksAreStealable)
+{
+	// the worker threads are not started; dequeue on behalf of the first two
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskScheduler* pTaskScheduler = SGD::H1TaskSchedulerLayer::GetTaskScheduler();
+	if (pTaskScheduler->GetWorkerThreadPool().GetWorkerThreadCounts() < 2)
+	{
+		SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+		return;
+	}
+	SGD::H1WorkerThread* pOwnerWorkerThread = pTaskScheduler->GetWorkerThreadPool().GetWorkerThreadByIndex(0);
+	SGD::H1WorkerThread* pThiefWorkerThread = pTaskScheduler->GetWorkerThreadPool().GetWorkerThreadByIndex(1);
+	pTaskScheduler->SetTaskDequeueBatchSize(8);
+
+	// the owner runs the first task and buffers the rest
+	SGD::H1TaskDeclaration tasks[4];
+	pTaskScheduler->EnqueueTaskRange(tasks, 4, SGD::ETQP_Mid);
+	EXPECT_EQ(&tasks[0], pTaskScheduler->DequeueTask(pOwnerWorkerThread));
+
+	// the idle worker thread takes the buffered tasks in FIFO order while the owner is busy
+	EXPECT_EQ(&tasks[1], pTaskScheduler->DequeueTask(pThiefWorkerThread));
+	EXPECT_EQ(&tasks[2], pTaskScheduler->DequeueTask(pThiefWorkerThread));
+	EXPECT_EQ(&tasks[3], pTaskScheduler->DequeueTask(pOwnerWorkerThread));
+	EXPECT_EQ(nullptr, pTaskScheduler->DequeueTask(pThiefWorkerThread));
+	EXPECT_EQ(true, pOwnerWorkerThread->GetLocalTaskBuffer().IsEmpty());
+
+	pTaskScheduler->SetTaskDequeueBatchSize(SGD::H1TaskScheduler::DefaultTaskDequeueBatchSize);
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+
+#if SGD_COROUTINE_SUPPORT
+SGD::H1CoroutineTask CoroutineAddNumbers(int32_t base, std::atomic<int32_t>* pSum)
+{
+	int32_t arrResults[2] = { 0, };
+	AddNumberData arrNumberData[2];
+	SGD::H1TaskDeclaration tasks[2];
+	for (int32_t i = 0; i < 2; ++i)
+	{
+		arrNumberData[i].a = base;
+		arrNumberData[i].b = i;
+		arrNumberData[i].result = &arrResults[i];
+		tasks[i].SetTaskEntryPoint(TaskEntryPoint_AddNumber);
+		tasks[i].SetTaskData(&arrNumberData[i]);
+	}
+
+	// only the coroutine frame is suspended while waiting child tasks
+	SGD::H1TaskCounter counter;
+	SGD::H1TaskSchedulerLayer::RunTasksWithCounter(tasks, 2, &counter);
+	co_await counter;
+
+	pSum->fetch_add(arrResults[0] + arrResults[1]);
+}
+
+TEST_F(TaskSchedulerTest, CoroutineTasksAwaitCounter)
+{
+	SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+
+	// more coroutines than fiber contexts in the pool
+	const int32_t coroutineCounts = 1000;
+	std::atomic<int32_t> sum(0);
+	SGD::H1TaskCounter coroutineCounter;
+	for (int32_t i = 0; i < coroutineCounts; ++i)
+		EXPECT_EQ(true, SGD::RunCoroutineTask(CoroutineAddNumbers(i, &sum), &coroutineCounter));
+	SGD::H1TaskSchedulerLayer::WaitForCounter(&coroutineCounter);
+
+	// sum of (2i + 1)
+	EXPECT_EQ(coroutineCounts * coroutineCounts, sum.load());
+
+	SGD::H1TaskDeclaration terminateThreadsTask(TaskEntryPoint_TerminateAllThreads, nullptr);
+	SGD::H1TaskCounter* counter = nullptr;
+	SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+	SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+	SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+	SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+}
+#endif
\ No newline at end of file
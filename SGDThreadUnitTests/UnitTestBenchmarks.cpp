@@ -0,0 +1,768 @@
+#include "SGDThreadUnitTestsPCH.h"
+#include "SGDTaskScheduler.h"
+#include "SGDWorkerThread.h"
+#include "SGDTaggedHeap.h"
+#include "SGDBoundedQueue.h"
+#include "SGDFiberMutex.h"
+#include "SGDFiberReaderWriterLock.h"
+#include "SGDReactor.h"
+#include "SGDAsyncFile.h"
+#include <mutex>
+
+// benchmarks are disabled by default; run them with '--gtest_also_run_disabled_tests --gtest_filter=*Benchmark*'
+class TaskSchedulerBenchmark : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		SGD::H1TaskSchedulerLayer::InitializeTaskScheduler();
+		SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().StartAll();
+	}
+
+	virtual void TearDown()
+	{
+		SGD::H1TaskDeclaration terminateThreadsTask(TerminateAllThreads, nullptr);
+		SGD::H1TaskCounter* counter = nullptr;
+		SGD::H1TaskSchedulerLayer::RunTasks(&terminateThreadsTask, 1, &counter);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().WaitAll();
+		SGD::H1TaskSchedulerLayer::DestroyTaskScheduler();
+	}
+
+	static void TerminateAllThreads(void* pTaskData)
+	{
+		SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().SignalQuitAll();
+	}
+
+	static double ToMilliseconds(uint64_t ticks)
+	{
+		return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SGD::appGetTimestampFrequency());
+	}
+
+	// run tasks from the main thread and return elapsed time in milliseconds
+	static double RunAndMeasure(SGD::H1TaskDeclaration* tasks, int32_t taskCounts)
+	{
+		SGD::H1TaskCounter* counter = nullptr;
+		uint64_t beginTimestamp = SGD::appGetTimestamp();
+		SGD::H1TaskSchedulerLayer::RunTasks(tasks, taskCounts, &counter);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		return ToMilliseconds(SGD::appGetTimestamp() - beginTimestamp);
+	}
+};
+
+//
+// tagged heap vs malloc
+//
+namespace
+{
+	const int32_t AllocationTaskCounts = 256;
+	const int32_t AllocationCountsPerTask = 4096;
+
+	struct AllocationBenchmarkData
+	{
+		SGD::H1TaggedHeap* taggedHeap;
+		SGD::H1MemoryTag tag;
+		void* allocations[AllocationCountsPerTask];
+	};
+
+	inline size_t GetAllocationSize(int32_t index)
+	{
+		// 16 ~ 256 bytes transient buffers
+		return 16 + static_cast<size_t>((index * 37) % 241);
+	}
+
+	void TaggedHeapAllocationTask(void* pTaskData)
+	{
+		AllocationBenchmarkData* pData = reinterpret_cast<AllocationBenchmarkData*>(pTaskData);
+		for (int32_t i = 0; i < AllocationCountsPerTask; ++i)
+		{
+			pData->allocations[i] = pData->taggedHeap->Allocate(pData->tag, GetAllocationSize(i));
+			*reinterpret_cast<char*>(pData->allocations[i]) = static_cast<char>(i);
+		}
+	}
+
+	void MallocAllocationTask(void* pTaskData)
+	{
+		AllocationBenchmarkData* pData = reinterpret_cast<AllocationBenchmarkData*>(pTaskData);
+		for (int32_t i = 0; i < AllocationCountsPerTask; ++i)
+		{
+			pData->allocations[i] = malloc(GetAllocationSize(i));
+			*reinterpret_cast<char*>(pData->allocations[i]) = static_cast<char>(i);
+		}
+		// transient buffers are freed at the end of the task
+		for (int32_t i = 0; i < AllocationCountsPerTask; ++i)
+			free(pData->allocations[i]);
+	}
+}
+
+TEST_F(TaskSchedulerBenchmark, DISABLED_TaggedHeapAllocationRate)
+{
+	SGD::H1TaggedHeap taggedHeap;
+	taggedHeap.Initialize(SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetWorkerThreadPool().GetWorkerThreadCounts());
+
+	std::vector<AllocationBenchmarkData> taskData(AllocationTaskCounts);
+	std::vector<SGD::H1TaskDeclaration> tasks(AllocationTaskCounts);
+	const double totalAllocations = static_cast<double>(AllocationTaskCounts) * AllocationCountsPerTask;
+
+	for (int32_t frame = 0; frame < 4; ++frame)
+	{
+		// tagged heap - the frame's tag is released at once after the frame
+		for (int32_t i = 0; i < AllocationTaskCounts; ++i)
+		{
+			taskData[i].taggedHeap = &taggedHeap;
+			taskData[i].tag = frame;
+			tasks[i].SetTaskEntryPoint(TaggedHeapAllocationTask);
+			tasks[i].SetTaskData(&taskData[i]);
+		}
+		double taggedHeapElapsed = RunAndMeasure(tasks.data(), AllocationTaskCounts);
+		taggedHeap.Release(frame);
+
+		// malloc/free
+		for (int32_t i = 0; i < AllocationTaskCounts; ++i)
+			tasks[i].SetTaskEntryPoint(MallocAllocationTask);
+		double mallocElapsed = RunAndMeasure(tasks.data(), AllocationTaskCounts);
+
+		printf("[frame %d] tagged heap: %.2f ms (%.1f M allocs/s), malloc: %.2f ms (%.1f M allocs/s), blocks: %d\n",
+			frame,
+			taggedHeapElapsed, totalAllocations / (taggedHeapElapsed * 1000.0),
+			mallocElapsed, totalAllocations / (mallocElapsed * 1000.0),
+			taggedHeap.GetBlockCounts());
+	}
+
+	taggedHeap.Destroy();
+}
+
+
+//
+// launching batches of tasks: bulk enqueue vs one-at-a-time enqueue
+//
+namespace
+{
+	void EmptyTask(void* pTaskData)
+	{
+
+	}
+}
+
+TEST_F(TaskSchedulerBenchmark, DISABLED_BulkEnqueueBatches)
+{
+	SGD::H1TaskQueue* pTaskQueue = SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetTaskQueue(SGD::ETQP_High);
+	std::vector<SGD::H1TaskDeclaration> tasks(64 * 1024);
+	for (SGD::H1TaskDeclaration& rTask : tasks)
+		rTask.SetTaskEntryPoint(EmptyTask);
+
+	for (int32_t batchSize = 64; batchSize <= 64 * 1024; batchSize *= 4)
+	{
+		SGD::H1TaskCounter* counter = nullptr;
+
+		// bulk enqueue (RunTasks)
+		uint64_t beginTimestamp = SGD::appGetTimestamp();
+		SGD::H1TaskSchedulerLayer::RunTasks(tasks.data(), batchSize, &counter);
+		double bulkEnqueueElapsed = ToMilliseconds(SGD::appGetTimestamp() - beginTimestamp);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		double bulkTotalElapsed = ToMilliseconds(SGD::appGetTimestamp() - beginTimestamp);
+
+		// one-at-a-time enqueue (previous EnqueueTaskRange)
+		beginTimestamp = SGD::appGetTimestamp();
+		SGD::H1TaskSchedulerLayer::BindTasks(tasks.data(), batchSize, &counter);
+		for (int32_t i = 0; i < batchSize; ++i)
+			pTaskQueue->EnqueueTask(&tasks[i]);
+		double singleEnqueueElapsed = ToMilliseconds(SGD::appGetTimestamp() - beginTimestamp);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		double singleTotalElapsed = ToMilliseconds(SGD::appGetTimestamp() - beginTimestamp);
+
+		printf("[batch %6d] bulk: enqueue %.3f ms, total %.3f ms | one-at-a-time: enqueue %.3f ms, total %.3f ms\n",
+			batchSize, bulkEnqueueElapsed, bulkTotalElapsed, singleEnqueueElapsed, singleTotalElapsed);
+	}
+}
+
+
+//
+// batched dequeue into the worker-local buffer vs one-at-a-time dequeue
+//
+TEST_F(TaskSchedulerBenchmark, DISABLED_BatchedDequeueTinyTasks)
+{
+	SGD::H1TaskScheduler* pTaskScheduler = SGD::H1TaskSchedulerLayer::GetTaskScheduler();
+	const int32_t taskCounts = 64 * 1024;
+	std::vector<SGD::H1TaskDeclaration> tasks(taskCounts);
+	for (SGD::H1TaskDeclaration& rTask : tasks)
+		rTask.SetTaskEntryPoint(EmptyTask);
+
+	const int32_t batchSizes[] = { 1, 4, 8, 16, 32 };
+	for (int32_t batchSize : batchSizes)
+	{
+		pTaskScheduler->SetTaskDequeueBatchSize(batchSize);
+
+		double elapsed = 0.0;
+		for (int32_t repeat = 0; repeat < 4; ++repeat)
+			elapsed += RunAndMeasure(tasks.data(), taskCounts);
+
+		printf("[dequeue batch %2d] %d tiny tasks: %.3f ms (%.1f K tasks/ms)\n",
+			batchSize, taskCounts, elapsed / 4.0, static_cast<double>(taskCounts) * 4.0 / elapsed / 1000.0);
+	}
+
+	pTaskScheduler->SetTaskDequeueBatchSize(SGD::H1TaskScheduler::DefaultTaskDequeueBatchSize);
+}
+
+
+//
+// bounded ring queue vs moodycamel (and concurrency::concurrent_queue with USE_MS_CONCURRENT_QUEUE)
+//	- raw queue throughput of pointers without the scheduler (worker threads don't compete for the cores)
+//
+namespace
+{
+	const uint32_t RingQueueCapacity = 1024;
+	const int32_t QueueElementCountsPerProducer = 256 * 1024;
+
+	struct BoundedRingQueueAdapter
+	{
+		BoundedRingQueueAdapter() { Queue.Initialize(RingQueueCapacity); }
+		inline bool TryEnqueue(void* pElement) { return Queue.TryEnqueue(pElement); }
+		inline bool TryDequeue(void*& pElement) { return Queue.TryDequeue(pElement); }
+		SGD::H1BoundedQueue<void*> Queue;
+	};
+
+	struct MoodycamelQueueAdapter
+	{
+		inline bool TryEnqueue(void* pElement) { return Queue.enqueue(pElement); }
+		inline bool TryDequeue(void*& pElement) { return Queue.try_dequeue(pElement); }
+		moodycamel::ConcurrentQueue<void*> Queue;
+	};
+
+#if USE_MS_CONCURRENT_QUEUE
+	struct MSConcurrentQueueAdapter
+	{
+		inline bool TryEnqueue(void* pElement) { Queue.push(pElement); return true; }
+		inline bool TryDequeue(void*& pElement) { return Queue.try_pop(pElement); }
+		concurrency::concurrent_queue<void*> Queue;
+	};
+#endif
+
+	// return elapsed time in milliseconds to pass all elements from the producers to the consumers
+	template <typename QueueAdapterType>
+	double MeasureQueueThroughput(int32_t producerCounts, int32_t consumerCounts)
+	{
+		QueueAdapterType queue;
+		const int64_t totalElementCounts = static_cast<int64_t>(producerCounts) * QueueElementCountsPerProducer;
+		std::atomic<int64_t> totalDequeuedCounts(0);
+		std::atomic<bool> bStart(false);
+
+		std::vector<std::thread> threads;
+		for (int32_t producer = 0; producer < producerCounts; ++producer)
+		{
+			threads.emplace_back([&]()
+			{
+				while (!bStart.load()) {}
+				for (int32_t i = 0; i < QueueElementCountsPerProducer; ++i)
+				{
+					while (!queue.TryEnqueue(reinterpret_cast<void*>(static_cast<uintptr_t>(i + 1))))
+						std::this_thread::yield();
+				}
+			});
+		}
+		for (int32_t consumer = 0; consumer < consumerCounts; ++consumer)
+		{
+			threads.emplace_back([&]()
+			{
+				while (!bStart.load()) {}
+				void* pElement = nullptr;
+				while (totalDequeuedCounts.load(std::memory_order_relaxed) < totalElementCounts)
+				{
+					if (queue.TryDequeue(pElement))
+						totalDequeuedCounts.fetch_add(1, std::memory_order_relaxed);
+					else
+						std::this_thread::yield();
+				}
+			});
+		}
+
+		uint64_t beginTimestamp = SGD::appGetTimestamp();
+		bStart.store(true);
+		for (std::thread& rThread : threads)
+			rThread.join();
+		return static_cast<double>(SGD::appGetTimestamp() - beginTimestamp) * 1000.0 / static_cast<double>(SGD::appGetTimestampFrequency());
+	}
+}
+
+TEST(QueueBenchmark, DISABLED_BoundedRingQueueVsConcurrentQueue)
+{
+	const int32_t threadCounts[] = { 1, 2, 4, 8 };
+	for (int32_t producerCounts : threadCounts)
+	{
+		for (int32_t consumerCounts : threadCounts)
+		{
+			const double elementCounts = static_cast<double>(producerCounts) * QueueElementCountsPerProducer;
+			double ringElapsed = MeasureQueueThroughput<BoundedRingQueueAdapter>(producerCounts, consumerCounts);
+			double moodycamelElapsed = MeasureQueueThroughput<MoodycamelQueueAdapter>(producerCounts, consumerCounts);
+			printf("[P %d / C %d] bounded ring: %.2f ms (%.1f M/s), moodycamel: %.2f ms (%.1f M/s)",
+				producerCounts, consumerCounts,
+				ringElapsed, elementCounts / (ringElapsed * 1000.0),
+				moodycamelElapsed, elementCounts / (moodycamelElapsed * 1000.0));
+#if USE_MS_CONCURRENT_QUEUE
+			double msElapsed = MeasureQueueThroughput<MSConcurrentQueueAdapter>(producerCounts, consumerCounts);
+			printf(", concurrent_queue: %.2f ms (%.1f M/s)", msElapsed, elementCounts / (msElapsed * 1000.0));
+#endif
+			printf("\n");
+		}
+	}
+}
+
+
+//
+// fiber mutex vs std::mutex under contention
+//
+namespace
+{
+	const int32_t LockCountsPerTask = 20000;
+
+	struct MutexBenchmarkData
+	{
+		SGD::H1FiberMutex fiberMutex;
+		std::mutex stdMutex;
+		uint64_t sharedValue;
+	};
+
+	inline void CriticalSectionWork(uint64_t& rValue)
+	{
+		// a few dependent operations in the critical section
+		for (int32_t i = 0; i < 8; ++i)
+			rValue = rValue * 6364136223846793005ull + 1442695040888963407ull;
+	}
+
+	void FiberMutexLockTask(void* pTaskData)
+	{
+		MutexBenchmarkData* pData = reinterpret_cast<MutexBenchmarkData*>(pTaskData);
+		for (int32_t i = 0; i < LockCountsPerTask; ++i)
+		{
+			SGD::H1FiberMutexScope lockScope(pData->fiberMutex);
+			CriticalSectionWork(pData->sharedValue);
+		}
+	}
+
+	void StdMutexLockTask(void* pTaskData)
+	{
+		MutexBenchmarkData* pData = reinterpret_cast<MutexBenchmarkData*>(pTaskData);
+		for (int32_t i = 0; i < LockCountsPerTask; ++i)
+		{
+			std::lock_guard<std::mutex> lockScope(pData->stdMutex);
+			CriticalSectionWork(pData->sharedValue);
+		}
+	}
+}
+
+TEST_F(TaskSchedulerBenchmark, DISABLED_FiberMutexContention)
+{
+	MutexBenchmarkData data;
+	data.sharedValue = 0;
+	std::vector<SGD::H1TaskDeclaration> tasks(64);
+
+	for (int32_t fiberCounts = 2; fiberCounts <= 64; fiberCounts *= 2)
+	{
+		for (int32_t i = 0; i < fiberCounts; ++i)
+		{
+			tasks[i].SetTaskEntryPoint(FiberMutexLockTask);
+			tasks[i].SetTaskData(&data);
+		}
+		double fiberMutexElapsed = RunAndMeasure(tasks.data(), fiberCounts);
+
+		for (int32_t i = 0; i < fiberCounts; ++i)
+			tasks[i].SetTaskEntryPoint(StdMutexLockTask);
+		double stdMutexElapsed = RunAndMeasure(tasks.data(), fiberCounts);
+
+		const double lockCounts = static_cast<double>(fiberCounts) * LockCountsPerTask;
+		printf("[%2d fibers] H1FiberMutex: %.2f ms (%.1f M locks/s), std::mutex: %.2f ms (%.1f M locks/s)\n",
+			fiberCounts,
+			fiberMutexElapsed, lockCounts / (fiberMutexElapsed * 1000.0),
+			stdMutexElapsed, lockCounts / (stdMutexElapsed * 1000.0));
+	}
+}
+
+
+//
+// fiber reader-writer lock vs fiber mutex with read-mostly mixes
+//
+namespace
+{
+	const int32_t AccessCountsPerTask = 20000;
+	const int32_t SharedStateCounts = 64;
+
+	struct ReaderWriterBenchmarkData
+	{
+		SGD::H1FiberReaderWriterLock readerWriterLock;
+		SGD::H1FiberMutex mutex;
+		// one write per 'writePeriod' accesses
+		int32_t writePeriod;
+		int32_t sharedStates[SharedStateCounts];
+		std::atomic<int64_t> readSum;
+	};
+
+	inline int64_t ReadSharedStates(const ReaderWriterBenchmarkData* pData)
+	{
+		int64_t sum = 0;
+		for (int32_t i = 0; i < SharedStateCounts; ++i)
+			sum += pData->sharedStates[i];
+		return sum;
+	}
+
+	inline void WriteSharedStates(ReaderWriterBenchmarkData* pData)
+	{
+		for (int32_t i = 0; i < SharedStateCounts; ++i)
+			pData->sharedStates[i]++;
+	}
+
+	void ReaderWriterLockAccessTask(void* pTaskData)
+	{
+		ReaderWriterBenchmarkData* pData = reinterpret_cast<ReaderWriterBenchmarkData*>(pTaskData);
+		int64_t sum = 0;
+		for (int32_t i = 0; i < AccessCountsPerTask; ++i)
+		{
+			if (i % pData->writePeriod == 0)
+			{
+				SGD::H1FiberWriteScope writeScope(pData->readerWriterLock);
+				WriteSharedStates(pData);
+			}
+			else
+			{
+				SGD::H1FiberReadScope readScope(pData->readerWriterLock);
+				sum += ReadSharedStates(pData);
+			}
+		}
+		pData->readSum += sum;
+	}
+
+	void MutexAccessTask(void* pTaskData)
+	{
+		ReaderWriterBenchmarkData* pData = reinterpret_cast<ReaderWriterBenchmarkData*>(pTaskData);
+		int64_t sum = 0;
+		for (int32_t i = 0; i < AccessCountsPerTask; ++i)
+		{
+			SGD::H1FiberMutexScope lockScope(pData->mutex);
+			if (i % pData->writePeriod == 0)
+				WriteSharedStates(pData);
+			else
+				sum += ReadSharedStates(pData);
+		}
+		pData->readSum += sum;
+	}
+}
+
+TEST_F(TaskSchedulerBenchmark, DISABLED_FiberReaderWriterLockReadMostly)
+{
+	ReaderWriterBenchmarkData data;
+	memset(data.sharedStates, 0, sizeof(data.sharedStates));
+	data.readSum = 0;
+
+	const int32_t taskCounts = 32;
+	std::vector<SGD::H1TaskDeclaration> tasks(taskCounts);
+	for (SGD::H1TaskDeclaration& rTask : tasks)
+		rTask.SetTaskData(&data);
+
+	// 99/1 and 90/10 read/write mixes
+	const int32_t writePeriods[] = { 100, 10 };
+	for (int32_t writePeriod : writePeriods)
+	{
+		data.writePeriod = writePeriod;
+
+		for (SGD::H1TaskDeclaration& rTask : tasks)
+			rTask.SetTaskEntryPoint(ReaderWriterLockAccessTask);
+		double readerWriterLockElapsed = RunAndMeasure(tasks.data(), taskCounts);
+
+		for (SGD::H1TaskDeclaration& rTask : tasks)
+			rTask.SetTaskEntryPoint(MutexAccessTask);
+		double mutexElapsed = RunAndMeasure(tasks.data(), taskCounts);
+
+		const double accessCounts = static_cast<double>(taskCounts) * AccessCountsPerTask;
+		printf("[read/write %d/%d] H1FiberReaderWriterLock: %.2f ms (%.1f M accesses/s), H1FiberMutex: %.2f ms (%.1f M accesses/s)\n",
+			100 - 100 / writePeriod, 100 / writePeriod,
+			readerWriterLockElapsed, accessCounts / (readerWriterLockElapsed * 1000.0),
+			mutexElapsed, accessCounts / (mutexElapsed * 1000.0));
+	}
+}
+
+//
+// fiber sleep accuracy (lateness of the wake-up over the requested time)
+//
+namespace
+{
+	const int32_t SleepCountsPerTask = 64;
+
+	struct SleepAccuracyBenchmarkData
+	{
+		uint32_t sleepMicroseconds;
+		std::atomic<uint64_t> totalLateness;
+		std::atomic<uint64_t> maxLateness;
+	};
+
+	void SleepAccuracyTask(void* pTaskData)
+	{
+		SleepAccuracyBenchmarkData* pData = reinterpret_cast<SleepAccuracyBenchmarkData*>(pTaskData);
+		for (int32_t i = 0; i < SleepCountsPerTask; ++i)
+		{
+			uint64_t deadline = SGD::H1TaskSchedulerLayer::GetDeadlineAfter(pData->sleepMicroseconds);
+			SGD::H1TaskSchedulerLayer::SleepUntil(deadline);
+			uint64_t lateness = SGD::appGetTimestamp() - deadline;
+
+			pData->totalLateness += lateness;
+			uint64_t maxLateness = pData->maxLateness.load();
+			while (lateness > maxLateness && !pData->maxLateness.compare_exchange_weak(maxLateness, lateness)) {}
+		}
+	}
+}
+
+TEST_F(TaskSchedulerBenchmark, DISABLED_FiberSleepAccuracy)
+{
+	const int32_t fiberCounts[] = { 1, 16, 64 };
+	const uint32_t sleepMicroseconds[] = { 100, 1000 };
+	for (uint32_t sleepTime : sleepMicroseconds)
+	{
+		for (int32_t taskCounts : fiberCounts)
+		{
+			SleepAccuracyBenchmarkData data;
+			data.sleepMicroseconds = sleepTime;
+			data.totalLateness = 0;
+			data.maxLateness = 0;
+
+			std::vector<SGD::H1TaskDeclaration> tasks(taskCounts);
+			for (SGD::H1TaskDeclaration& rTask : tasks)
+			{
+				rTask.SetTaskEntryPoint(SleepAccuracyTask);
+				rTask.SetTaskData(&data);
+			}
+			double elapsed = RunAndMeasure(tasks.data(), taskCounts);
+
+			const double sleepCounts = static_cast<double>(taskCounts) * SleepCountsPerTask;
+			printf("[sleep %u us, %d fibers] elapsed: %.2f ms, lateness avg: %.1f us, max: %.1f us\n",
+				sleepTime, taskCounts, elapsed,
+				ToMilliseconds(data.totalLateness.load()) * 1000.0 / sleepCounts,
+				ToMilliseconds(data.maxLateness.load()) * 1000.0);
+		}
+	}
+}
+
+//
+// loopback request-response: fiber per request on the reactor vs thread per connection (blocking sockets)
+//
+namespace
+{
+	const int32_t RpcMessageBytes = 64;
+	const int32_t RpcRequestCountsPerConnection = 2000;
+	const int32_t RpcMaxConnectionCounts = 32;
+
+	struct RpcBenchmarkData
+	{
+		// null reactor means blocking descriptors (thread per connection)
+		SGD::H1Reactor* reactor;
+		SGD::H1IODescriptor listener;
+		uint16_t port;
+		int32_t connectionCounts;
+		SGD::H1IODescriptor connections[RpcMaxConnectionCounts];
+		SGD::H1TaskCounter connectionCounter;
+		std::atomic<int32_t> failedCounts;
+	};
+
+	void RpcServeConnection(void* pData)
+	{
+		SGD::H1IODescriptor* pConnection = reinterpret_cast<SGD::H1IODescriptor*>(pData);
+		uint8_t message[RpcMessageBytes];
+		while (pConnection->ReadExactly(message, sizeof(message)))
+			pConnection->Write(message, sizeof(message));
+		pConnection->Destroy();
+	}
+
+	void RpcRunClient(RpcBenchmarkData* pData)
+	{
+		SGD::H1IODescriptor client;
+		if (!client.Initialize(SGD::H1IODescriptor::CreateSocket(), pData->reactor) || !client.ConnectLoopback(pData->port))
+		{
+			pData->failedCounts++;
+			client.Destroy();
+			return;
+		}
+
+		uint8_t request[RpcMessageBytes];
+		uint8_t response[RpcMessageBytes];
+		memset(request, 0x5a, sizeof(request));
+		for (int32_t i = 0; i < RpcRequestCountsPerConnection; ++i)
+		{
+			if (client.Write(request, sizeof(request)) != sizeof(request) || !client.ReadExactly(response, sizeof(response)))
+			{
+				pData->failedCounts++;
+				break;
+			}
+		}
+		client.Destroy();
+	}
+
+	void RpcAcceptTask(void* pTaskData)
+	{
+		RpcBenchmarkData* pData = reinterpret_cast<RpcBenchmarkData*>(pTaskData);
+		for (int32_t i = 0; i < pData->connectionCounts; ++i)
+		{
+			pData->connections[i].Initialize(pData->listener.Accept(), pData->reactor);
+			SGD::H1TaskSchedulerLayer::SpawnTask(RpcServeConnection, &pData->connections[i], &pData->connectionCounter);
+		}
+	}
+
+	void RpcClientTask(void* pTaskData)
+	{
+		RpcRunClient(reinterpret_cast<RpcBenchmarkData*>(pTaskData));
+	}
+}
+
+TEST_F(TaskSchedulerBenchmark, DISABLED_ReactorLoopbackRequestsPerSecond)
+{
+	const int32_t connectionCounts[] = { 1, 8, 32 };
+	for (int32_t connections : connectionCounts)
+	{
+		// fiber per connection on the reactor (the server and the clients share the worker threads)
+		RpcBenchmarkData fiberData;
+		fiberData.reactor = &SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetReactor();
+		fiberData.port = 0;
+		fiberData.connectionCounts = connections;
+		fiberData.failedCounts = 0;
+		fiberData.listener.Initialize(SGD::H1IODescriptor::CreateLoopbackListener(fiberData.port), fiberData.reactor);
+
+		std::vector<SGD::H1TaskDeclaration> tasks(connections + 1);
+		tasks[0].SetTaskEntryPoint(RpcAcceptTask);
+		tasks[0].SetTaskData(&fiberData);
+		for (int32_t i = 1; i <= connections; ++i)
+		{
+			tasks[i].SetTaskEntryPoint(RpcClientTask);
+			tasks[i].SetTaskData(&fiberData);
+		}
+		uint64_t beginTimestamp = SGD::appGetTimestamp();
+		SGD::H1TaskCounter* counter = nullptr;
+		SGD::H1TaskSchedulerLayer::RunTasks(tasks.data(), int32_t(tasks.size()), &counter);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(counter);
+		SGD::H1TaskSchedulerLayer::WaitForCounter(&fiberData.connectionCounter);
+		double fiberElapsed = ToMilliseconds(SGD::appGetTimestamp() - beginTimestamp);
+		fiberData.listener.Destroy();
+
+		// thread per connection with blocking descriptors
+		RpcBenchmarkData threadData;
+		threadData.reactor = nullptr;
+		threadData.port = 0;
+		threadData.connectionCounts = connections;
+		threadData.failedCounts = 0;
+		threadData.listener.Initialize(SGD::H1IODescriptor::CreateLoopbackListener(threadData.port), nullptr);
+
+		beginTimestamp = SGD::appGetTimestamp();
+		std::vector<std::thread> threads;
+		threads.emplace_back([&threadData]()
+		{
+			std::vector<std::thread> serverThreads;
+			for (int32_t i = 0; i < threadData.connectionCounts; ++i)
+			{
+				threadData.connections[i].Initialize(threadData.listener.Accept(), nullptr);
+				serverThreads.emplace_back(RpcServeConnection, &threadData.connections[i]);
+			}
+			for (std::thread& rThread : serverThreads)
+				rThread.join();
+		});
+		for (int32_t i = 0; i < connections; ++i)
+			threads.emplace_back(RpcRunClient, &threadData);
+		for (std::thread& rThread : threads)
+			rThread.join();
+		double threadElapsed = ToMilliseconds(SGD::appGetTimestamp() - beginTimestamp);
+		threadData.listener.Destroy();
+
+		const double requestCounts = static_cast<double>(connections) * RpcRequestCountsPerConnection;
+		printf("[%2d connections] fiber/reactor: %.2f ms (%.0f requests/s), thread per connection: %.2f ms (%.0f requests/s), failed: %d/%d\n",
+			connections, fiberElapsed, requestCounts * 1000.0 / fiberElapsed, threadElapsed, requestCounts * 1000.0 / threadElapsed,
+			fiberData.failedCounts.load(), threadData.failedCounts.load());
+	}
+}
+
+//
+// async file reads of 4KB chunks at queue depths through the offload thread pool
+//
+namespace
+{
+	const int32_t FileChunkBytes = 4096;
+	// page-cached file; the reads are scattered over it
+	const int32_t FileChunkCounts = 16384;
+	const int32_t FileReadCounts = 100000;
+
+	struct FileReadBenchmarkData
+	{
+		SGD::FileHandle handle;
+		// requests in flight per reader fiber
+		int32_t depth;
+		int32_t readCounts;
+		std::atomic<int32_t> failedCounts;
+	};
+
+	void FileReadTask(void* pTaskData)
+	{
+		FileReadBenchmarkData* pData = reinterpret_cast<FileReadBenchmarkData*>(pTaskData);
+		SGD::H1AsyncFileIO& asyncFileIO = SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetAsyncFileIO();
+
+		std::vector<uint8_t> buffers(size_t(pData->depth) * FileChunkBytes);
+		std::vector<SGD::H1FileIORequest> requests(pData->depth);
+		uint32_t random = uint32_t(reinterpret_cast<uintptr_t>(&buffers));
+		for (int32_t issuedCounts = 0; issuedCounts < pData->readCounts; issuedCounts += pData->depth)
+		{
+			// issue the wave of the reads, then wait for all of them
+			int32_t waveCounts = std::min(pData->depth, pData->readCounts - issuedCounts);
+			SGD::H1FiberLatch latch(waveCounts);
+			for (int32_t i = 0; i < waveCounts; ++i)
+			{
+				random = random * 1664525u + 1013904223u;
+				requests[i].Operation = SGD::EFIO_Read;
+				requests[i].Handle = pData->handle;
+				requests[i].Buffer = &buffers[size_t(i) * FileChunkBytes];
+				requests[i].Size = FileChunkBytes;
+				requests[i].Offset = uint64_t((random >> 8) % FileChunkCounts) * FileChunkBytes;
+				requests[i].Latch = &latch;
+				asyncFileIO.Submit(&requests[i]);
+			}
+			latch.Wait();
+
+			for (int32_t i = 0; i < waveCounts; ++i)
+			{
+				if (requests[i].Result != FileChunkBytes)
+					pData->failedCounts++;
+			}
+		}
+	}
+}
+
+TEST_F(TaskSchedulerBenchmark, DISABLED_AsyncFileReadQueueDepth)
+{
+	SGD::H1AsyncFileIO& asyncFileIO = SGD::H1TaskSchedulerLayer::GetTaskScheduler()->GetAsyncFileIO();
+	const char* path = "SGDAsyncFileIOBenchmark.bin";
+	SGD::FileHandle handle = SGD::H1AsyncFileIO::OpenFile(path, SGD::EFOM_ReadWrite);
+	ASSERT_NE(SGD::InvalidFileHandle, handle);
+
+	std::vector<uint8_t> chunk(FileChunkBytes, 0x5a);
+	for (int32_t i = 0; i < FileChunkCounts; ++i)
+		ASSERT_EQ(FileChunkBytes, asyncFileIO.Write(handle, chunk.data(), chunk.size(), uint64_t(i) * FileChunkBytes));
+
+	const int32_t queueDepths[] = { 1, 4, 16, 64, 256 };
+	for (int32_t queueDepth : queueDepths)
+	{
+		// up to 4 reader fibers share the queue depth
+		const int32_t readerCounts = std::min(queueDepth, 4);
+		std::vector<FileReadBenchmarkData> readers(readerCounts);
+		std::vector<SGD::H1TaskDeclaration> tasks(readerCounts);
+		for (int32_t i = 0; i < readerCounts; ++i)
+		{
+			readers[i].handle = handle;
+			readers[i].depth = queueDepth / readerCounts;
+			readers[i].readCounts = FileReadCounts / readerCounts;
+			readers[i].failedCounts = 0;
+			tasks[i].SetTaskEntryPoint(FileReadTask);
+			tasks[i].SetTaskData(&readers[i]);
+		}
+		double elapsed = RunAndMeasure(tasks.data(), readerCounts);
+		int32_t failedCounts = 0;
+		for (int32_t i = 0; i < readerCounts; ++i)
+			failedCounts += readers[i].failedCounts.load();
+
+		printf("[QD %3d] offload pool: %.2f ms (%.0f reads/s), failed: %d\n",
+			queueDepth, elapsed, FileReadCounts * 1000.0 / elapsed, failedCounts);
+	}
+
+	SGD::H1AsyncFileIO::CloseFile(handle);
+	std::remove(path);
+}